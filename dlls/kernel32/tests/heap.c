@@ -892,6 +892,85 @@ static void test_HeapQueryInformation(void)
     ok(info == 0 || info == 1 || info == 2, "expected 0, 1 or 2, got %u\n", info);
 }
 
+static void test_HeapSetInformation(void)
+{
+    static const SIZE_T sizes[] = { 1, 17, 100, 1000, 10000 };
+    void *ptrs[ARRAY_SIZE(sizes)], *p;
+    HANDLE heap;
+    ULONG info;
+    SIZE_T size;
+    BOOL ret;
+    int i, j;
+
+    if (!pHeapQueryInformation)
+    {
+        win_skip("HeapQueryInformation is not available\n");
+        return;
+    }
+
+    heap = HeapCreate(HEAP_NO_SERIALIZE, 0, 0);
+    ok(heap != NULL, "HeapCreate failed\n");
+    info = 2;
+    SetLastError(0xdeadbeef);
+    ret = HeapSetInformation(heap, HeapCompatibilityInformation, &info, sizeof(info));
+    ok(!ret, "HeapSetInformation succeeded on a HEAP_NO_SERIALIZE heap\n");
+    HeapDestroy(heap);
+
+    heap = HeapCreate(0, 0, 0);
+    ok(heap != NULL, "HeapCreate failed\n");
+
+    info = 0xdeadbeef;
+    ret = pHeapQueryInformation(heap, HeapCompatibilityInformation, &info, sizeof(info), NULL);
+    ok(ret, "HeapQueryInformation error %u\n", GetLastError());
+    ok(info == 0, "expected 0, got %u\n", info);
+
+    info = 2;
+    ret = HeapSetInformation(heap, HeapCompatibilityInformation, &info, sizeof(info));
+    if (!ret)
+    {
+        /* fails when a debugger or debug heap flags are active */
+        skip("Cannot enable the low fragmentation heap\n");
+        HeapDestroy(heap);
+        return;
+    }
+
+    info = 0xdeadbeef;
+    ret = pHeapQueryInformation(heap, HeapCompatibilityInformation, &info, sizeof(info), NULL);
+    ok(ret, "HeapQueryInformation error %u\n", GetLastError());
+    ok(info == 2, "expected 2, got %u\n", info);
+
+    for (j = 0; j < 3; j++)
+    {
+        for (i = 0; i < ARRAY_SIZE(sizes); i++)
+        {
+            ptrs[i] = HeapAlloc(heap, HEAP_ZERO_MEMORY, sizes[i]);
+            ok(ptrs[i] != NULL, "HeapAlloc failed for size %lu\n", sizes[i]);
+            ok(!((BYTE *)ptrs[i])[sizes[i] - 1], "memory not zeroed for size %lu\n", sizes[i]);
+            size = HeapSize(heap, 0, ptrs[i]);
+            ok(size == sizes[i], "expected size %lu, got %lu\n", sizes[i], size);
+            ok(HeapValidate(heap, 0, ptrs[i]), "HeapValidate failed for size %lu\n", sizes[i]);
+            memset(ptrs[i], 0xcc, sizes[i]);
+        }
+        for (i = 0; i < ARRAY_SIZE(sizes); i++)
+        {
+            ret = HeapFree(heap, 0, ptrs[i]);
+            ok(ret, "HeapFree failed for size %lu\n", sizes[i]);
+        }
+    }
+
+    p = HeapAlloc(heap, 0, 17);
+    ok(p != NULL, "HeapAlloc failed\n");
+    p = HeapReAlloc(heap, 0, p, 5000);
+    ok(p != NULL, "HeapReAlloc failed\n");
+    size = HeapSize(heap, 0, p);
+    ok(size == 5000, "expected size 5000, got %lu\n", size);
+    ret = HeapFree(heap, 0, p);
+    ok(ret, "HeapFree failed\n");
+
+    ok(HeapValidate(heap, 0, NULL), "HeapValidate failed\n");
+    HeapDestroy(heap);
+}
+
 static void test_heap_checks( DWORD flags )
 {
     BYTE old, *p, *p2;
@@ -1245,6 +1324,7 @@ START_TEST(heap)
     test_sized_HeapReAlloc((1 << 20), 1);
 
     test_HeapQueryInformation();
+    test_HeapSetInformation();
     test_GetPhysicallyInstalledSystemMemory();
 
     if (pRtlGetNtGlobalFlags)
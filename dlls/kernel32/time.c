@@ -92,6 +92,19 @@ static inline ULONGLONG monotonic_counter(void)
     return counter.QuadPart;
 }
 
+/* return a monotonic time counter with only millisecond accuracy, in Win32 ticks;
+ * this has to match NtGetTickCount */
+static inline ULONGLONG monotonic_counter_coarse(void)
+{
+#if defined(HAVE_CLOCK_GETTIME) && defined(CLOCK_MONOTONIC_COARSE)
+    struct timespec ts;
+
+    if (!clock_gettime( CLOCK_MONOTONIC_COARSE, &ts ))
+        return ts.tv_sec * (ULONGLONG)TICKSPERSEC + ts.tv_nsec / 100;
+#endif
+    return monotonic_counter();
+}
+
 
 /***********************************************************************
  *           GetSystemTimeAdjustment     (KERNEL32.@)
@@ -418,7 +431,7 @@ BOOL WINAPI QueryThreadCycleTime(HANDLE thread, PULONG64 cycle)
  */
 ULONGLONG WINAPI DECLSPEC_HOTPATCH GetTickCount64(void)
 {
-    return monotonic_counter() / TICKSPERMSEC;
+    return monotonic_counter_coarse() / TICKSPERMSEC;
 }
 
 /***********************************************************************
@@ -437,5 +450,5 @@ ULONGLONG WINAPI DECLSPEC_HOTPATCH GetTickCount64(void)
  */
 DWORD WINAPI DECLSPEC_HOTPATCH GetTickCount(void)
 {
-    return monotonic_counter() / TICKSPERMSEC;
+    return monotonic_counter_coarse() / TICKSPERMSEC;
 }
@@ -4083,6 +4083,33 @@ static void test_iswdigit(void)
     }
 }
 
+static void test_wcslen_wcschr(void)
+{
+    WCHAR buf[64], *str, *r;
+    int off, len, i;
+
+    for (off = 0; off < 8; off++)
+    {
+        str = buf + off;
+        for (len = 0; len < 40; len++)
+        {
+            for (i = 0; i < len; i++) str[i] = 0x7f01 + i * 0x101;
+            str[len] = 0;
+            str[len + 1] = 0x8000;
+
+            ok(wcslen(str) == len, "%d/%d) wcslen returned %d\n", off, len, (int)wcslen(str));
+            for (i = 0; i <= len; i++)
+            {
+                r = wcschr(str, str[i]);
+                ok(r == str + i, "%d/%d) wcschr(%x) returned %p, expected %p\n",
+                   off, len, str[i], r, str + i);
+            }
+            r = wcschr(str, 0x8000);
+            ok(!r, "%d/%d) wcschr returned %p\n", off, len, r);
+        }
+    }
+}
+
 START_TEST(string)
 {
     char mem[100];
@@ -4228,4 +4255,5 @@ START_TEST(string)
     test_C_locale();
     test_strstr();
     test_iswdigit();
+    test_wcslen_wcschr();
 }
@@ -2500,12 +2500,37 @@ int CDECL MSVCRT_towlower(MSVCRT_wint_t c)
     return MSVCRT__towlower_l(c, NULL);
 }
 
+/* word at a time scanning: a machine word holds several wchars, and an
+ * aligned word never straddles a page boundary, so it is safe to read
+ * whole words up to the one holding the terminator */
+#define WCS_WORD_ONES   (~(ULONG_PTR)0 / 0xffff)
+#define WCS_WORD_HIGHS  (WCS_WORD_ONES << 15)
+
+static inline BOOL wcs_word_has_zero(ULONG_PTR word)
+{
+    return ((word - WCS_WORD_ONES) & ~word & WCS_WORD_HIGHS) != 0;
+}
+
 /*********************************************************************
  *              wcschr (MSVCRT.@)
  */
 MSVCRT_wchar_t* CDECL MSVCRT_wcschr(const MSVCRT_wchar_t *str, MSVCRT_wchar_t ch)
 {
-    return strchrW(str, ch);
+    const ULONG_PTR pattern = ch * WCS_WORD_ONES;
+    const ULONG_PTR *word;
+
+    if ((ULONG_PTR)str % sizeof(*str)) return strchrW(str, ch);
+
+    for (; (ULONG_PTR)str % sizeof(*word); str++)
+    {
+        if (*str == ch) return (MSVCRT_wchar_t *)str;
+        if (!*str) return NULL;
+    }
+
+    for (word = (const ULONG_PTR *)str; ; word++)
+        if (wcs_word_has_zero(*word) || wcs_word_has_zero(*word ^ pattern)) break;
+
+    return strchrW((const MSVCRT_wchar_t *)word, ch);
 }
 
 /*********************************************************************
@@ -2521,7 +2546,18 @@ MSVCRT_wchar_t* CDECL MSVCRT_wcsrchr(const MSVCRT_wchar_t *str, MSVCRT_wchar_t c
  */
 int CDECL MSVCRT_wcslen(const MSVCRT_wchar_t *str)
 {
-    return strlenW(str);
+    const MSVCRT_wchar_t *s = str;
+    const ULONG_PTR *word;
+
+    if ((ULONG_PTR)s % sizeof(*s)) return strlenW(str);
+
+    for (; (ULONG_PTR)s % sizeof(*word); s++)
+        if (!*s) return s - str;
+
+    for (word = (const ULONG_PTR *)s; !wcs_word_has_zero(*word); word++) ;
+
+    for (s = (const MSVCRT_wchar_t *)word; *s; s++) ;
+    return s - str;
 }
 
 /*********************************************************************
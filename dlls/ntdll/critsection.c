@@ -42,7 +42,7 @@ WINE_DECLARE_DEBUG_CHANNEL(relay);
 
 static inline void small_pause(void)
 {
-#ifdef __i386__
+#if defined(__i386__) || defined(__x86_64__)
     __asm__ __volatile__( "rep;nop" : : : "memory" );
 #else
     __asm__ __volatile__( "" : : : "memory" );
@@ -56,6 +56,13 @@ static BOOL crit_section_has_debuginfo(const RTL_CRITICAL_SECTION *crit)
     return crit->DebugInfo != NULL && crit->DebugInfo != no_debug_info_marker;
 }
 
+/* sections without any debug info pointer have been made global by
+ * MakeCriticalSectionGlobal, and need to use the shared semaphore */
+static BOOL crit_section_is_global(const RTL_CRITICAL_SECTION *crit)
+{
+    return crit->DebugInfo == NULL;
+}
+
 #ifdef __linux__
 
 static int wait_op = 128; /*FUTEX_WAIT|FUTEX_PRIVATE_FLAG*/
@@ -222,8 +229,7 @@ static inline NTSTATUS wait_semaphore( RTL_CRITICAL_SECTION *crit, int timeout )
 {
     NTSTATUS ret;
 
-    /* debug info is cleared by MakeCriticalSectionGlobal */
-    if (!crit_section_has_debuginfo( crit ) || ((ret = fast_wait( crit, timeout )) == STATUS_NOT_IMPLEMENTED))
+    if (crit_section_is_global( crit ) || ((ret = fast_wait( crit, timeout )) == STATUS_NOT_IMPLEMENTED))
     {
         HANDLE sem = get_semaphore( crit );
         LARGE_INTEGER time;
@@ -401,6 +407,7 @@ NTSTATUS WINAPI RtlDeleteCriticalSection( RTL_CRITICAL_SECTION *crit )
         }
         close_semaphore( crit );
     }
+    else if (!crit_section_is_global( crit )) close_semaphore( crit );
     else NtClose( crit->LockSemaphore );
     crit->LockSemaphore = 0;
     return STATUS_SUCCESS;
@@ -512,8 +519,7 @@ NTSTATUS WINAPI RtlpUnWaitCriticalSection( RTL_CRITICAL_SECTION *crit )
 {
     NTSTATUS ret;
 
-    /* debug info is cleared by MakeCriticalSectionGlobal */
-    if (!crit_section_has_debuginfo( crit ) || ((ret = fast_wake( crit )) == STATUS_NOT_IMPLEMENTED))
+    if (crit_section_is_global( crit ) || ((ret = fast_wake( crit )) == STATUS_NOT_IMPLEMENTED))
     {
         HANDLE sem = get_semaphore( crit );
         ret = NtReleaseSemaphore( sem, 1, NULL );
@@ -158,6 +158,11 @@ typedef struct
 
 #define MAX_IGNORED_FILES 4
 
+#define DIR_CACHE_SLOTS        8        /* number of directories kept in the name cache */
+#define DIR_CACHE_MIN_SIZE     0x2000   /* directories smaller than this are cheap enough to scan */
+#define DIR_CACHE_MAX_ENTRIES  0x40000  /* directories larger than this are not cached */
+#define DIR_CACHE_MTIME_SLACK  2        /* worst case mtime granularity in seconds (FAT) */
+
 struct file_identity
 {
     dev_t dev;
@@ -211,6 +216,24 @@ static const unsigned int dir_data_names_initial_size  = 64;
 static struct dir_data **dir_data_cache;
 static unsigned int dir_data_cache_size;
 
+/* cached contents of a large directory, for case-insensitive lookups */
+struct dir_cache
+{
+    struct dir_data        *data;       /* directory names, in readdir order */
+    struct file_identity    id;         /* directory device and inode */
+    BOOL                    too_large;  /* directory has too many entries to be cached */
+    time_t                  mtime;      /* directory modification time when the names were read */
+    long                    mtime_nsec;
+    BOOL                    stable;     /* mtime was old enough when the names were read */
+    unsigned int            last_use;   /* for LRU replacement */
+    unsigned int            hash_size;  /* size of the hash table, a power of 2 */
+    unsigned int           *hash_table; /* index + 1 of the first name for each hash value */
+    unsigned int           *hash_next;  /* index + 1 of the next name with the same hash value */
+};
+
+static struct dir_cache dir_caches[DIR_CACHE_SLOTS];
+static unsigned int dir_cache_clock;
+
 static BOOL show_dot_files;
 static RTL_RUN_ONCE init_once = RTL_RUN_ONCE_INIT;
 
@@ -1506,16 +1529,7 @@ static NTSTATUS get_dir_data_entry( struct dir_data *dir_data, void *info_ptr, I
     struct stat st;
     ULONG name_len, start, dir_size, attributes;
 
-    if (get_file_info( names->unix_name, &st, &attributes ) == -1)
-    {
-        TRACE( "file no longer exists %s\n", names->unix_name );
-        return STATUS_SUCCESS;
-    }
-    if (is_ignored_file( &st ))
-    {
-        TRACE( "ignoring file %s\n", names->unix_name );
-        return STATUS_SUCCESS;
-    }
+    /* check for space first, so that we don't stat entries that will be retrieved by the next call */
     start = dir_info_align( io->Information );
     dir_size = dir_info_size( class, 0 );
     if (start + dir_size > max_length) return STATUS_MORE_ENTRIES;
@@ -1525,6 +1539,21 @@ static NTSTATUS get_dir_data_entry( struct dir_data *dir_data, void *info_ptr, I
     /* if this is not the first entry, fail; the first entry is always returned (but truncated) */
     if (*last_info && name_len > max_length) return STATUS_MORE_ENTRIES;
 
+    /* names only don't need any file information, unless we have to check for ignored files */
+    if (class != FileNamesInformation || ignored_files_count)
+    {
+        if (get_file_info( names->unix_name, &st, &attributes ) == -1)
+        {
+            TRACE( "file no longer exists %s\n", names->unix_name );
+            return STATUS_SUCCESS;
+        }
+        if (is_ignored_file( &st ))
+        {
+            TRACE( "ignoring file %s\n", names->unix_name );
+            return STATUS_SUCCESS;
+        }
+    }
+
     info = (union file_directory_info *)((char *)info_ptr + start);
     info->dir.NextEntryOffset = 0;
     info->dir.FileIndex = 0;  /* NTFS always has 0 here, so let's not bother with it */
@@ -2026,6 +2055,203 @@ NTSTATUS WINAPI DECLSPEC_HOTPATCH NtQueryDirectoryFile( HANDLE handle, HANDLE ev
 }
 
 
+/***********************************************************************
+ *           hash_dir_cache_name
+ */
+static unsigned int hash_dir_cache_name( const WCHAR *name, int length )
+{
+    unsigned int hash = 0;
+
+    /* fold case the same way as strncmpiW */
+    while (length--) hash = hash * 31 + tolowerW( *name++ );
+    return hash;
+}
+
+
+/***********************************************************************
+ *           get_dir_mtime_nsec
+ */
+static inline long get_dir_mtime_nsec( const struct stat *st )
+{
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+    return st->st_mtim.tv_nsec;
+#elif defined(HAVE_STRUCT_STAT_ST_MTIMESPEC)
+    return st->st_mtimespec.tv_nsec;
+#else
+    return 0;
+#endif
+}
+
+
+/***********************************************************************
+ *           free_dir_cache
+ */
+static void free_dir_cache( struct dir_cache *cache )
+{
+    free_dir_data( cache->data );
+    RtlFreeHeap( GetProcessHeap(), 0, cache->hash_table );
+    memset( cache, 0, sizeof(*cache) );
+}
+
+
+/***********************************************************************
+ *           fill_dir_cache
+ *
+ * Read all the names of a directory and hash them case-insensitively.
+ * dir_section must be held by caller.
+ */
+static BOOL fill_dir_cache( struct dir_cache *cache, const char *unix_name, const struct stat *st )
+{
+    static const WCHAR empty[1];
+    WCHAR buffer[MAX_DIR_ENTRY_LEN + 1];
+    struct dir_data *data;
+    struct dirent *de;
+    unsigned int i, hash;
+    DIR *dir;
+    int len;
+
+    cache->id.dev     = st->st_dev;
+    cache->id.ino     = st->st_ino;
+    cache->mtime      = st->st_mtime;
+    cache->mtime_nsec = get_dir_mtime_nsec( st );
+
+    if (!(dir = opendir( unix_name ))) return FALSE;
+    if (!(data = RtlAllocateHeap( GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*data) )))
+    {
+        closedir( dir );
+        return FALSE;
+    }
+
+    while ((de = readdir( dir )))
+    {
+        if (data->count >= DIR_CACHE_MAX_ENTRIES) break;
+        len = ntdll_umbstowcs( 0, de->d_name, strlen(de->d_name), buffer, MAX_DIR_ENTRY_LEN );
+        if (len < 0) continue;
+        buffer[len] = 0;
+        if (!add_dir_data_names( data, buffer, empty, de->d_name )) break;
+    }
+    closedir( dir );
+    if (de)
+    {
+        /* remember the directory, so that it isn't read again on every lookup */
+        if (data->count >= DIR_CACHE_MAX_ENTRIES) cache->too_large = TRUE;
+        goto failed;
+    }
+
+    for (cache->hash_size = 16; cache->hash_size < data->count; cache->hash_size *= 2) ;
+    if (!(cache->hash_table = RtlAllocateHeap( GetProcessHeap(), HEAP_ZERO_MEMORY,
+                                               (cache->hash_size + data->count) * sizeof(unsigned int) )))
+        goto failed;
+    cache->hash_next = cache->hash_table + cache->hash_size;
+
+    /* insert backwards so that chains are in readdir order, like a directory scan */
+    for (i = data->count; i > 0; i--)
+    {
+        const WCHAR *long_name = data->names[i - 1].long_name;
+        hash = hash_dir_cache_name( long_name, strlenW( long_name )) & (cache->hash_size - 1);
+        cache->hash_next[i - 1] = cache->hash_table[hash];
+        cache->hash_table[hash] = i;
+    }
+
+    data->id.dev      = st->st_dev;
+    data->id.ino      = st->st_ino;
+    cache->data       = data;
+    /* a change made within the mtime granularity of the last one may not
+     * update the mtime, so a recently modified directory can't be trusted */
+    cache->stable     = time( NULL ) > st->st_mtime + DIR_CACHE_MTIME_SLACK;
+    TRACE( "cached %u names for %s\n", data->count, debugstr_a(unix_name) );
+    return TRUE;
+
+failed:
+    free_dir_data( data );
+    cache->hash_size = 0;
+    return FALSE;
+}
+
+
+/***********************************************************************
+ *           lookup_dir_cache
+ *
+ * Case-insensitive lookup of a name in the cached contents of a large
+ * directory. unix_name contains the directory name, terminated at pos - 1.
+ * Returns STATUS_SUCCESS with the file name appended at pos if found,
+ * STATUS_OBJECT_NAME_NOT_FOUND if no entry has that name, and
+ * STATUS_NOT_SUPPORTED if the directory has to be scanned instead.
+ */
+static NTSTATUS lookup_dir_cache( char *unix_name, int pos, const WCHAR *name, int length )
+{
+    struct dir_cache *cache = NULL, *lru = &dir_caches[0];
+    NTSTATUS status = STATUS_OBJECT_NAME_NOT_FOUND;
+    struct stat st;
+    unsigned int i;
+
+    if (stat( unix_name, &st ) == -1 || st.st_size < DIR_CACHE_MIN_SIZE) return STATUS_NOT_SUPPORTED;
+
+    RtlEnterCriticalSection( &dir_section );
+
+    for (i = 0; i < DIR_CACHE_SLOTS; i++)
+    {
+        struct dir_cache *slot = &dir_caches[i];
+
+        if ((slot->data || slot->too_large) && slot->id.dev == st.st_dev && slot->id.ino == st.st_ino)
+        {
+            if (slot->too_large && slot->mtime == st.st_mtime &&
+                slot->mtime_nsec == get_dir_mtime_nsec( &st ))
+            {
+                slot->last_use = ++dir_cache_clock;
+                RtlLeaveCriticalSection( &dir_section );
+                return STATUS_NOT_SUPPORTED;
+            }
+            if (slot->data && slot->mtime == st.st_mtime && slot->mtime_nsec == get_dir_mtime_nsec( &st ) &&
+                (slot->stable || time( NULL ) <= st.st_mtime + DIR_CACHE_MTIME_SLACK))
+                cache = slot;
+            else
+                lru = slot;  /* directory changed, reload it */
+            break;
+        }
+        if (slot->last_use < lru->last_use) lru = slot;
+    }
+
+    if (!cache)
+    {
+        free_dir_cache( lru );
+        if (!fill_dir_cache( lru, unix_name, &st ))
+        {
+            if (lru->too_large) lru->last_use = ++dir_cache_clock;
+            RtlLeaveCriticalSection( &dir_section );
+            return STATUS_NOT_SUPPORTED;
+        }
+        cache = lru;
+    }
+    cache->last_use = ++dir_cache_clock;
+
+    for (i = cache->hash_table[hash_dir_cache_name( name, length ) & (cache->hash_size - 1)];
+         i; i = cache->hash_next[i - 1])
+    {
+        const struct dir_data_names *names = &cache->data->names[i - 1];
+
+        if (strlenW( names->long_name ) == length && !strncmpiW( names->long_name, name, length ))
+        {
+            unix_name[pos - 1] = '/';
+            strcpy( unix_name + pos, names->unix_name );
+            status = STATUS_SUCCESS;
+            break;
+        }
+    }
+
+    /* names in a recently modified directory have to be checked the hard way */
+    if (!cache->stable)
+    {
+        if (status == STATUS_SUCCESS && lstat( unix_name, &st ) == -1) status = STATUS_NOT_SUPPORTED;
+        if (status == STATUS_OBJECT_NAME_NOT_FOUND) status = STATUS_NOT_SUPPORTED;
+        if (status == STATUS_NOT_SUPPORTED) unix_name[pos - 1] = 0;
+    }
+
+    RtlLeaveCriticalSection( &dir_section );
+    return status;
+}
+
+
 /***********************************************************************
  *           find_file_in_dir
  *
@@ -2077,6 +2303,17 @@ static NTSTATUS find_file_in_dir( char *unix_name, int pos, const WCHAR *name, i
 
     if (!is_name_8_dot_3 && !get_dir_case_sensitivity( unix_name )) goto not_found;
 
+    /* try the cached contents of large directories */
+
+    switch (lookup_dir_cache( unix_name, pos, name, length ))
+    {
+    case STATUS_SUCCESS:
+        goto success;
+    case STATUS_OBJECT_NAME_NOT_FOUND:
+        if (!is_name_8_dot_3) goto not_found;  /* short names are only matched by a full scan */
+        break;
+    }
+
     /* now look for it through the directory */
 
 #ifdef VFAT_IOCTL_READDIR_BOTH
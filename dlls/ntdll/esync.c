@@ -200,6 +200,17 @@ static void *get_shm( unsigned int idx )
     return ret;
 }
 
+/* Counters reported through +esync, to help diagnose fd exhaustion. */
+static int fds_in_use;      /* eventfds currently cached */
+static int fd_failures;     /* objects we couldn't get an eventfd for */
+static int fallback_waits;  /* waits delegated to the server */
+
+static void trace_counters( const char *reason )
+{
+    TRACE("%s: %d eventfds in use, %d fd failures, %d server waits.\n",
+          reason, fds_in_use, fd_failures, fallback_waits);
+}
+
 /* We'd like lookup to be fast. To that end, we use a static list indexed by handle.
  * This is copied and adapted from the fd cache code. */
 
@@ -242,6 +253,7 @@ static struct esync *add_to_list( HANDLE handle, enum esync_type type, int fd, v
     {
         esync_list[entry][idx].fd = fd;
         esync_list[entry][idx].shm = shm;
+        if (!(interlocked_xchg_add( &fds_in_use, 1 ) % 1024)) trace_counters( "fd usage" );
     }
     return &esync_list[entry][idx];
 }
@@ -319,12 +331,32 @@ static NTSTATUS get_object( HANDLE handle, struct esync **obj )
         return ret;
     }
 
+    if (fd == -1)
+    {
+        /* We ran out of fds. Server objects can still be waited on by the
+         * server, but the server can't wait on or signal esync objects. */
+        interlocked_xchg_add( &fd_failures, 1 );
+        trace_counters( "no fd" );
+        return shm_idx ? STATUS_TOO_MANY_OPENED_FILES : STATUS_NOT_IMPLEMENTED;
+    }
+
     TRACE("Got fd %d for handle %p.\n", fd, handle);
 
     *obj = add_to_list( handle, type, fd, shm_idx ? get_shm( shm_idx ) : 0 );
     return ret;
 }
 
+/* Gets an esync semaphore, event or mutex. Server objects have no shared
+ * state we could operate on, so the caller has to fall back to the server. */
+static NTSTATUS get_sync_object( HANDLE handle, struct esync **obj )
+{
+    NTSTATUS ret;
+
+    if ((ret = get_object( handle, obj ))) return ret;
+    if (!(*obj)->shm) return STATUS_NOT_IMPLEMENTED;
+    return STATUS_SUCCESS;
+}
+
 NTSTATUS esync_close( HANDLE handle )
 {
     UINT_PTR entry, idx = handle_to_index( handle, &entry );
@@ -336,6 +368,7 @@ NTSTATUS esync_close( HANDLE handle )
         if (interlocked_xchg((int *)&esync_list[entry][idx].type, 0))
         {
             close( esync_list[entry][idx].fd );
+            interlocked_xchg_add( &fds_in_use, -1 );
             return STATUS_SUCCESS;
         }
     }
@@ -379,7 +412,17 @@ static NTSTATUS create_esync( enum esync_type type, HANDLE *handle,
     SERVER_END_REQ;
     server_leave_uninterrupted_section( &fd_cache_section, &sigset );
 
-    if (!ret || ret == STATUS_OBJECT_NAME_EXISTS)
+    if ((!ret || ret == STATUS_OBJECT_NAME_EXISTS) && fd == -1)
+    {
+        interlocked_xchg_add( &fd_failures, 1 );
+        trace_counters( "no fd" );
+        NtClose( *handle );
+        *handle = 0;
+        /* A new object can be replaced by a server object, but an existing
+         * esync object can't be used without an fd. */
+        ret = ret ? STATUS_INSUFFICIENT_RESOURCES : STATUS_TOO_MANY_OPENED_FILES;
+    }
+    else if (!ret || ret == STATUS_OBJECT_NAME_EXISTS)
     {
         add_to_list( *handle, type, fd, shm_idx ? get_shm( shm_idx ) : 0 );
 
@@ -420,7 +463,15 @@ static NTSTATUS open_esync( enum esync_type type, HANDLE *handle,
     SERVER_END_REQ;
     server_leave_uninterrupted_section( &fd_cache_section, &sigset );
 
-    if (!ret)
+    if (!ret && fd == -1)
+    {
+        interlocked_xchg_add( &fd_failures, 1 );
+        trace_counters( "no fd" );
+        NtClose( *handle );
+        *handle = 0;
+        ret = STATUS_TOO_MANY_OPENED_FILES;
+    }
+    else if (!ret)
     {
         add_to_list( *handle, type, fd, shm_idx ? get_shm( shm_idx ) : 0 );
 
@@ -456,7 +507,7 @@ NTSTATUS esync_release_semaphore( HANDLE handle, ULONG count, ULONG *prev )
 
     TRACE("%p, %d, %p.\n", handle, count, prev);
 
-    if ((ret = get_object( handle, &obj))) return ret;
+    if ((ret = get_sync_object( handle, &obj ))) return ret;
     semaphore = obj->shm;
 
     do
@@ -495,7 +546,7 @@ NTSTATUS esync_query_semaphore( HANDLE handle, SEMAPHORE_INFORMATION_CLASS class
         return STATUS_INVALID_INFO_CLASS;
     }
 
-    if ((ret = get_object( handle, &obj ))) return ret;
+    if ((ret = get_sync_object( handle, &obj ))) return ret;
     semaphore = obj->shm;
 
     out->CurrentCount = semaphore->count;
@@ -596,7 +647,7 @@ NTSTATUS esync_set_event( HANDLE handle, LONG *prev )
 
     TRACE("handle %p, prev %p.\n", handle, prev);
 
-    if ((ret = get_object( handle, &obj ))) return ret;
+    if ((ret = get_sync_object( handle, &obj ))) return ret;
     event = obj->shm;
 
     if (obj->type == ESYNC_MANUAL_EVENT)
@@ -643,7 +694,7 @@ NTSTATUS esync_reset_event( HANDLE handle, LONG *prev )
 
     TRACE("handle %p, prev %p.\n", handle, prev);
 
-    if ((ret = get_object( handle, &obj ))) return ret;
+    if ((ret = get_sync_object( handle, &obj ))) return ret;
     event = obj->shm;
 
     if (obj->type == ESYNC_MANUAL_EVENT)
@@ -688,7 +739,7 @@ NTSTATUS esync_pulse_event( HANDLE handle, LONG *prev )
 
     TRACE("%p.\n", handle);
 
-    if ((ret = get_object( handle, &obj ))) return ret;
+    if ((ret = get_sync_object( handle, &obj ))) return ret;
     event = obj->shm;
 
     /* Acquire the spinlock. */
@@ -732,7 +783,7 @@ NTSTATUS esync_query_event( HANDLE handle, EVENT_INFORMATION_CLASS class,
         return STATUS_INVALID_INFO_CLASS;
     }
 
-    if ((ret = get_object( handle, &obj ))) return ret;
+    if ((ret = get_sync_object( handle, &obj ))) return ret;
 
     fd.fd = obj->fd;
     fd.events = POLLIN;
@@ -769,7 +820,7 @@ NTSTATUS esync_release_mutex( HANDLE *handle, LONG *prev )
 
     TRACE("%p, %p.\n", handle, prev);
 
-    if ((ret = get_object( handle, &obj ))) return ret;
+    if ((ret = get_sync_object( handle, &obj ))) return ret;
     mutex = obj->shm;
 
     /* This is thread-safe, because the only thread that can change the tid to
@@ -810,7 +861,7 @@ NTSTATUS esync_query_mutex( HANDLE handle, MUTANT_INFORMATION_CLASS class,
         return STATUS_INVALID_INFO_CLASS;
     }
 
-    if ((ret = get_object( handle, &obj ))) return ret;
+    if ((ret = get_sync_object( handle, &obj ))) return ret;
     mutex = obj->shm;
 
     out->CurrentCount = 1 - mutex->count;
@@ -976,6 +1027,8 @@ static NTSTATUS __esync_wait_objects( DWORD count, const HANDLE *handles,
     else if (has_server)
     {
         /* It's just server objects, so delegate to the server. */
+        interlocked_xchg_add( &fallback_waits, 1 );
+        if (TRACE_ON(esync)) trace_counters( "server wait" );
         return STATUS_NOT_IMPLEMENTED;
     }
 
@@ -601,25 +601,141 @@ static RUNTIME_FUNCTION *find_function_info( ULONG_PTR pc, ULONG_PTR base,
     return NULL;
 }
 
+/* cache of the function tables of recently used modules, to avoid walking
+ * the module list and parsing the image headers for every unwound frame */
+struct function_table_cache_entry
+{
+    LONG              seq;     /* odd while the entry is being updated */
+    ULONG_PTR         base;
+    ULONG_PTR         end;
+    LDR_MODULE       *module;
+    RUNTIME_FUNCTION *table;
+    ULONG             count;
+};
+
+#define FUNCTION_TABLE_CACHE_SIZE 8
+
+static struct function_table_cache_entry function_table_cache[FUNCTION_TABLE_CACHE_SIZE];
+static LONG function_table_cache_next;
+static LONG function_table_cache_gen;  /* incremented on every flush */
+
+static BOOL get_cached_function_table( ULONG_PTR pc, ULONG_PTR *base, LDR_MODULE **module,
+                                       RUNTIME_FUNCTION **table, ULONG *count )
+{
+    struct function_table_cache_entry *entry, copy;
+    unsigned int i;
+
+    for (i = 0; i < FUNCTION_TABLE_CACHE_SIZE; i++)
+    {
+        entry = &function_table_cache[i];
+        copy.seq = __atomic_load_n( &entry->seq, __ATOMIC_SEQ_CST );
+        if (copy.seq & 1) continue;
+        copy.base   = entry->base;
+        copy.end    = entry->end;
+        copy.module = entry->module;
+        copy.table  = entry->table;
+        copy.count  = entry->count;
+        __atomic_thread_fence( __ATOMIC_ACQUIRE );
+        if (__atomic_load_n( &entry->seq, __ATOMIC_SEQ_CST ) != copy.seq) continue;
+        if (pc < copy.base || pc >= copy.end) continue;
+
+        *base   = copy.base;
+        *module = copy.module;
+        *table  = copy.table;
+        *count  = copy.count;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+static void set_cached_function_table( LONG gen, LDR_MODULE *module, RUNTIME_FUNCTION *table, ULONG count )
+{
+    struct function_table_cache_entry *entry;
+    LONG seq;
+
+    entry = &function_table_cache[(ULONG)interlocked_xchg_add( &function_table_cache_next, 1 ) %
+                                  FUNCTION_TABLE_CACHE_SIZE];
+    seq = __atomic_load_n( &entry->seq, __ATOMIC_SEQ_CST );
+    /* don't bother if somebody else is updating that entry */
+    if ((seq & 1) || interlocked_cmpxchg( &entry->seq, seq + 1, seq ) != seq) return;
+
+    /* the module may have been unloaded since it was looked up */
+    if (__atomic_load_n( &function_table_cache_gen, __ATOMIC_SEQ_CST ) != gen)
+    {
+        __atomic_store_n( &entry->seq, seq + 2, __ATOMIC_SEQ_CST );
+        return;
+    }
+
+    entry->base   = (ULONG_PTR)module->BaseAddress;
+    entry->end    = (ULONG_PTR)module->BaseAddress + module->SizeOfImage;
+    entry->module = module;
+    entry->table  = table;
+    entry->count  = count;
+    __atomic_store_n( &entry->seq, seq + 2, __ATOMIC_SEQ_CST );
+}
+
+/**********************************************************************
+ *           flush_function_table_cache
+ *
+ * Remove a module from the function table cache before it gets unloaded.
+ */
+void flush_function_table_cache( void *base )
+{
+    struct function_table_cache_entry *entry;
+    unsigned int i;
+    LONG seq;
+
+    /* prevent entries looked up before the flush from being inserted */
+    interlocked_xchg_add( &function_table_cache_gen, 1 );
+
+    for (i = 0; i < FUNCTION_TABLE_CACHE_SIZE; i++)
+    {
+        entry = &function_table_cache[i];
+        for (;;)
+        {
+            seq = __atomic_load_n( &entry->seq, __ATOMIC_SEQ_CST );
+            if (seq & 1) continue;  /* wait for the pending update */
+            if (entry->base != (ULONG_PTR)base) break;
+            if (interlocked_cmpxchg( &entry->seq, seq + 1, seq ) != seq) continue;
+            entry->base   = 0;
+            entry->end    = 0;
+            entry->module = NULL;
+            entry->table  = NULL;
+            entry->count  = 0;
+            __atomic_store_n( &entry->seq, seq + 2, __ATOMIC_SEQ_CST );
+            break;
+        }
+    }
+}
+
 /**********************************************************************
  *           lookup_function_info
  */
 RUNTIME_FUNCTION *lookup_function_info( ULONG_PTR pc, ULONG_PTR *base, LDR_MODULE **module )
 {
-    RUNTIME_FUNCTION *func = NULL;
+    RUNTIME_FUNCTION *func = NULL, *table;
     struct dynamic_unwind_entry *entry;
-    ULONG size;
+    ULONG size, count;
+    LONG gen = __atomic_load_n( &function_table_cache_gen, __ATOMIC_SEQ_CST );
 
     /* PE module or wine module */
-    if (!LdrFindEntryForAddress( (void *)pc, module ))
+    if (get_cached_function_table( pc, base, module, &table, &count ))
+    {
+        /* lookup in function table */
+        if (table) func = find_function_info( pc, *base, table, count );
+    }
+    else if (!LdrFindEntryForAddress( (void *)pc, module ))
     {
         *base = (ULONG_PTR)(*module)->BaseAddress;
-        if ((func = RtlImageDirectoryEntryToData( (*module)->BaseAddress, TRUE,
-                                                  IMAGE_DIRECTORY_ENTRY_EXCEPTION, &size )))
+        count = 0;
+        if ((table = RtlImageDirectoryEntryToData( (*module)->BaseAddress, TRUE,
+                                                   IMAGE_DIRECTORY_ENTRY_EXCEPTION, &size )))
         {
             /* lookup in function table */
-            func = find_function_info( pc, (ULONG_PTR)(*module)->BaseAddress, func, size/sizeof(*func) );
+            count = size / sizeof(*table);
+            func = find_function_info( pc, *base, table, count );
         }
+        set_cached_function_table( gen, *module, table, count );
     }
     else
     {
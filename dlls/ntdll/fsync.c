@@ -27,6 +27,7 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #ifdef HAVE_SYS_MMAN_H
 # include <sys/mman.h>
 #endif
@@ -222,6 +223,56 @@ static struct fsync *add_to_list( HANDLE handle, enum fsync_type type, void *shm
     return &fsync_list[entry][idx];
 }
 
+/* handle to fsync object map published by the server, see FSYNC_HANDLE_MAP_ENTRIES */
+static const unsigned int *handle_map;
+
+static void init_handle_map(void)
+{
+    obj_handle_t dummy;
+    sigset_t sigset;
+    void *map;
+    int fd = -1;
+
+    server_enter_uninterrupted_section( &fd_cache_section, &sigset );
+    SERVER_START_REQ( get_fsync_handle_map )
+    {
+        if (!wine_server_call( req )) fd = receive_fd( &dummy );
+    }
+    SERVER_END_REQ;
+    server_leave_uninterrupted_section( &fd_cache_section, &sigset );
+
+    if (fd == -1)
+    {
+        WARN("Failed to get the handle map, falling back to server lookups.\n");
+        return;
+    }
+
+    map = mmap( NULL, FSYNC_HANDLE_MAP_ENTRIES * sizeof(*handle_map), PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+    if (map == MAP_FAILED)
+    {
+        WARN("Failed to map the handle map: %s\n", strerror( errno ));
+        return;
+    }
+    handle_map = map;
+}
+
+/* look up a handle in the server-published map and add it to the cache */
+static struct fsync *get_mapped_object( HANDLE handle )
+{
+    UINT_PTR idx = (((UINT_PTR)handle) >> 2) - 1;
+    unsigned int entry;
+
+    if (!handle_map || idx >= FSYNC_HANDLE_MAP_ENTRIES) return NULL;
+    if (!(entry = __atomic_load_n( &handle_map[idx], __ATOMIC_SEQ_CST ))) return NULL;
+
+    TRACE("Got shm index %d for handle %p from the handle map.\n",
+          entry >> FSYNC_HANDLE_MAP_TYPE_BITS, handle);
+
+    return add_to_list( handle, entry & ((1 << FSYNC_HANDLE_MAP_TYPE_BITS) - 1),
+                        get_shm( entry >> FSYNC_HANDLE_MAP_TYPE_BITS ) );
+}
+
 static struct fsync *get_cached_object( HANDLE handle )
 {
     UINT_PTR entry, idx = handle_to_index( handle, &entry );
@@ -250,6 +301,9 @@ static NTSTATUS get_object( HANDLE handle, struct fsync **obj )
         return STATUS_NOT_IMPLEMENTED;
     }
 
+    /* The server may already have told us about it. */
+    if ((*obj = get_mapped_object( handle ))) return STATUS_SUCCESS;
+
     /* We need to try grabbing it from the server. */
     SERVER_START_REQ( get_fsync_idx )
     {
@@ -401,6 +455,8 @@ void fsync_init(void)
 
     shm_addrs = RtlAllocateHeap( GetProcessHeap(), HEAP_ZERO_MEMORY, 128 * sizeof(shm_addrs[0]) );
     shm_addrs_size = 128;
+
+    init_handle_map();
 }
 
 NTSTATUS fsync_create_semaphore( HANDLE *handle, ACCESS_MASK access,
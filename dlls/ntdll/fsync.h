@@ -22,6 +22,10 @@ extern int do_fsync(void) DECLSPEC_HIDDEN;
 extern void fsync_init(void) DECLSPEC_HIDDEN;
 extern NTSTATUS fsync_close( HANDLE handle ) DECLSPEC_HIDDEN;
 
+/* We have to synchronize on the fd cache CS so that our calls to receive_fd
+ * don't race with theirs. */
+extern RTL_CRITICAL_SECTION fd_cache_section;
+
 extern NTSTATUS fsync_create_semaphore(HANDLE *handle, ACCESS_MASK access,
     const OBJECT_ATTRIBUTES *attr, LONG initial, LONG max) DECLSPEC_HIDDEN;
 extern NTSTATUS fsync_release_semaphore( HANDLE handle, ULONG count, ULONG *prev ) DECLSPEC_HIDDEN;
@@ -93,6 +93,7 @@ typedef struct
 #define ARENA_PENDING_MAGIC    0xbedead
 #define ARENA_FREE_MAGIC       0x45455246
 #define ARENA_LARGE_MAGIC      0x6752614c
+#define ARENA_LFH_MAGIC        0x48464c    /* in-use block parked in a low fragmentation heap bucket */
 
 #define ARENA_INUSE_FILLER     0x55
 #define ARENA_TAIL_FILLER      0xab
@@ -130,6 +131,21 @@ C_ASSERT( sizeof(ARENA_LARGE) % LARGE_ALIGNMENT == 0 );
 /* number of free lists */
 #define HEAP_NB_FREE_LISTS  128
 
+/* largest block size handled by the low fragmentation front-end */
+#define HEAP_LFH_MAX_SIZE  0x4000
+/* returns low fragmentation bucket index for a given block size */
+#define HEAP_SIZE_TO_LFH_INDEX(size) \
+    (((size) - HEAP_MIN_DATA_SIZE) / ALIGNMENT)
+/* number of low fragmentation buckets */
+#define HEAP_NB_LFH_BUCKETS  (HEAP_SIZE_TO_LFH_INDEX(HEAP_LFH_MAX_SIZE) + 1)
+/* max number of blocks kept in a low fragmentation bucket */
+#define HEAP_LFH_MAX_DEPTH  256
+
+/* values for HeapCompatibilityInformation */
+#define HEAP_STD  0
+#define HEAP_LAL  1
+#define HEAP_LFH  2
+
 struct tagHEAP;
 
 typedef struct tagSUBHEAP
@@ -164,6 +180,8 @@ typedef struct tagHEAP
     struct list     *freeList;      /* Free lists */
     struct wine_rb_tree freeTree;   /* Free tree */
     unsigned long    freeMask[HEAP_NB_FREE_LISTS / (8 * sizeof(unsigned long))];
+    ULONG            compat_info;   /* HeapCompatibilityInformation value */
+    SLIST_HEADER    *lfh_buckets;   /* Low fragmentation heap per size class block cache */
 } HEAP;
 
 #define HEAP_FREEMASK_BLOCK    (8 * sizeof(unsigned long))
@@ -326,7 +344,8 @@ static void subheap_notify_free_all(SUBHEAP const *subheap)
         {
             ARENA_INUSE const *pArena = (ARENA_INUSE const *)ptr;
             if (pArena->magic == ARENA_INUSE_MAGIC) notify_free(pArena + 1);
-            else if (pArena->magic != ARENA_PENDING_MAGIC) ERR("bad inuse_magic @%p\n", pArena);
+            else if (pArena->magic != ARENA_PENDING_MAGIC && pArena->magic != ARENA_LFH_MAGIC)
+                ERR("bad inuse_magic @%p\n", pArena);
             ptr += sizeof(*pArena) + (pArena->size & ARENA_SIZE_MASK);
         }
     }
@@ -793,6 +812,95 @@ static void HEAP_ShrinkBlock(SUBHEAP *subheap, ARENA_INUSE *pArena, SIZE_T size)
 }
 
 
+/***********************************************************************
+ *           lfh_alloc_block
+ *
+ * Allocate a block from the low fragmentation front-end without taking
+ * the heap lock. Returns NULL if the matching bucket is empty.
+ */
+static void *lfh_alloc_block( HEAP *heap, DWORD flags, SIZE_T size, SIZE_T rounded_size )
+{
+    SLIST_ENTRY *entry;
+    ARENA_INUSE *arena;
+
+    if (rounded_size > HEAP_LFH_MAX_SIZE) return NULL;
+    if (!(entry = RtlInterlockedPopEntrySList( &heap->lfh_buckets[HEAP_SIZE_TO_LFH_INDEX(rounded_size)] )))
+        return NULL;
+
+    /* blocks are bucketed by exact arena size, so the unused size is the same as for a fresh block */
+    arena = (ARENA_INUSE *)entry - 1;
+    arena->magic = ARENA_INUSE_MAGIC;
+    arena->unused_bytes = (arena->size & ARENA_SIZE_MASK) - size;
+
+    notify_alloc( arena + 1, size, flags & HEAP_ZERO_MEMORY );
+    initialize_block( arena + 1, size, arena->unused_bytes, flags );
+    return arena + 1;
+}
+
+
+/***********************************************************************
+ *           lfh_free_block
+ *
+ * Park a small in-use block in its low fragmentation bucket instead of
+ * merging it back into the free lists. The block must have been checked
+ * with validate_block_pointer, and stays an in-use arena for the rest of
+ * the heap code. Returns FALSE if the block has to be freed the slow way.
+ */
+static BOOL lfh_free_block( HEAP *heap, ARENA_INUSE *arena )
+{
+    SLIST_HEADER *bucket;
+    SIZE_T size;
+
+    size = arena->size & ARENA_SIZE_MASK;
+    if (size < HEAP_MIN_DATA_SIZE || size > HEAP_LFH_MAX_SIZE) return FALSE;
+
+    bucket = &heap->lfh_buckets[HEAP_SIZE_TO_LFH_INDEX(size)];
+    if (RtlQueryDepthSList( bucket ) >= HEAP_LFH_MAX_DEPTH) return FALSE;
+
+    arena->magic = ARENA_LFH_MAGIC;
+    RtlInterlockedPushEntrySList( bucket, (SLIST_ENTRY *)(arena + 1) );
+    return TRUE;
+}
+
+
+/***********************************************************************
+ *           enable_lfh
+ *
+ * Switch a heap to the low fragmentation front-end.
+ */
+static NTSTATUS enable_lfh( HEAP *heap )
+{
+    SLIST_HEADER *buckets = NULL;
+    SIZE_T size = HEAP_NB_LFH_BUCKETS * sizeof(*buckets);
+    NTSTATUS status = STATUS_SUCCESS;
+    unsigned int i;
+
+    /* debug heaps need every free to go through the arena code */
+    if ((heap->flags & (HEAP_NO_SERIALIZE | HEAP_SHARED | HEAP_PAGE_ALLOCS | HEAP_VALIDATE |
+                        HEAP_TAIL_CHECKING_ENABLED | HEAP_FREE_CHECKING_ENABLED)) || heap->pending_free)
+    {
+        WARN( "Heap %p: cannot enable LFH on heap with flags %08x\n", heap, heap->flags );
+        return STATUS_UNSUCCESSFUL;
+    }
+
+    enter_critical_section( &heap->critSection );
+    if (!heap->lfh_buckets)
+    {
+        if (!(status = NtAllocateVirtualMemory( NtCurrentProcess(), (void **)&buckets, 0, &size,
+                                                MEM_COMMIT, PAGE_READWRITE )))
+        {
+            for (i = 0; i < HEAP_NB_LFH_BUCKETS; i++) RtlInitializeSListHead( &buckets[i] );
+            heap->lfh_buckets = buckets;
+            heap->compat_info = HEAP_LFH;
+        }
+    }
+    leave_critical_section( &heap->critSection );
+
+    TRACE( "heap %p status %08x\n", heap, status );
+    return status;
+}
+
+
 /***********************************************************************
  *           allocate_large_block
  */
@@ -1009,6 +1117,8 @@ static SUBHEAP *HEAP_CreateSubHeap( HEAP *heap, LPVOID address, DWORD flags,
         heap->flags         = flags;
         heap->magic         = HEAP_MAGIC;
         heap->grow_size     = max( HEAP_DEF_SIZE, totalSize );
+        heap->compat_info   = HEAP_STD;
+        heap->lfh_buckets   = NULL;
         list_init( &heap->subheap_list );
         list_init( &heap->large_list );
 
@@ -1352,7 +1462,8 @@ static BOOL HEAP_ValidateInUseArena( const SUBHEAP *subheap, const ARENA_INUSE *
     }
 
     /* Check magic number */
-    if (pArena->magic != ARENA_INUSE_MAGIC && pArena->magic != ARENA_PENDING_MAGIC)
+    if (pArena->magic != ARENA_INUSE_MAGIC && pArena->magic != ARENA_PENDING_MAGIC &&
+        pArena->magic != ARENA_LFH_MAGIC)
     {
         if (quiet == NOISY) {
             ERR("Heap %p: invalid in-use arena magic %08x for %p\n", subheap->heap, pArena->magic, pArena );
@@ -1567,7 +1678,7 @@ static BOOL validate_block_pointer( HEAP *heap, SUBHEAP **ret_subheap, const ARE
         ret = HEAP_ValidateInUseArena( subheap, arena, QUIET );
     else if ((ULONG_PTR)arena % ALIGNMENT != ARENA_OFFSET)
         WARN( "Heap %p: unaligned arena pointer %p\n", subheap->heap, arena );
-    else if (arena->magic == ARENA_PENDING_MAGIC)
+    else if (arena->magic == ARENA_PENDING_MAGIC || arena->magic == ARENA_LFH_MAGIC)
         WARN( "Heap %p: block %p used after free\n", subheap->heap, arena + 1 );
     else if (arena->magic != ARENA_INUSE_MAGIC)
         WARN( "Heap %p: invalid in-use arena magic %08x for %p\n", subheap->heap, arena->magic, arena );
@@ -1776,6 +1887,12 @@ HANDLE WINAPI RtlDestroyHeap( HANDLE heap )
         addr = heapPtr->pending_free;
         NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
     }
+    if (heapPtr->lfh_buckets)
+    {
+        size = 0;
+        addr = heapPtr->lfh_buckets;
+        NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
+    }
     size = 0;
     addr = heapPtr->subheap.base;
     NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
@@ -1807,6 +1924,7 @@ void * WINAPI DECLSPEC_HOTPATCH RtlAllocateHeap( HANDLE heap, ULONG flags, SIZE_
     SUBHEAP *subheap;
     HEAP *heapPtr = HEAP_GetPtr( heap );
     SIZE_T rounded_size;
+    void *ret;
 
     /* Validate the parameters */
 
@@ -1821,11 +1939,17 @@ void * WINAPI DECLSPEC_HOTPATCH RtlAllocateHeap( HANDLE heap, ULONG flags, SIZE_
     }
     if (rounded_size < HEAP_MIN_DATA_SIZE) rounded_size = HEAP_MIN_DATA_SIZE;
 
+    if (heapPtr->lfh_buckets && (ret = lfh_alloc_block( heapPtr, flags, size, rounded_size )))
+    {
+        TRACE("(%p,%08x,%08lx): returning %p\n", heap, flags, size, ret );
+        return ret;
+    }
+
     if (!(flags & HEAP_NO_SERIALIZE)) enter_critical_section( &heapPtr->critSection );
 
     if (rounded_size >= HEAP_MIN_LARGE_BLOCK_SIZE && (flags & HEAP_GROWABLE))
     {
-        void *ret = allocate_large_block( heap, flags, size );
+        ret = allocate_large_block( heap, flags, size );
         if (!(flags & HEAP_NO_SERIALIZE)) leave_critical_section( &heapPtr->critSection );
         if (!ret && (flags & HEAP_GENERATE_EXCEPTIONS)) RtlRaiseStatus( STATUS_NO_MEMORY );
         TRACE("(%p,%08x,%08lx): returning %p\n", heap, flags, size, ret );
@@ -1904,18 +2028,19 @@ BOOLEAN WINAPI DECLSPEC_HOTPATCH RtlFreeHeap( HANDLE heap, ULONG flags, void *pt
 
     flags &= HEAP_NO_SERIALIZE;
     flags |= heapPtr->flags;
+    pInUse  = (ARENA_INUSE *)ptr - 1;
+
     if (!(flags & HEAP_NO_SERIALIZE)) enter_critical_section( &heapPtr->critSection );
 
     /* Inform valgrind we are trying to free memory, so it can throw up an error message */
     notify_free( ptr );
 
     /* Some sanity checks */
-    pInUse  = (ARENA_INUSE *)ptr - 1;
     if (!validate_block_pointer( heapPtr, &subheap, pInUse )) goto error;
 
     if (!subheap)
         free_large_block( heapPtr, flags, ptr );
-    else
+    else if (!heapPtr->lfh_buckets || !lfh_free_block( heapPtr, pInUse ))
         HEAP_MakeInUseBlockFree( subheap, pInUse );
 
     if (!(flags & HEAP_NO_SERIALIZE)) leave_critical_section( &heapPtr->critSection );
@@ -2271,7 +2396,8 @@ NTSTATUS WINAPI RtlWalkHeap( HANDLE heap, PVOID entry_ptr )
         }
 
         if (((ARENA_INUSE *)ptr - 1)->magic == ARENA_INUSE_MAGIC ||
-            ((ARENA_INUSE *)ptr - 1)->magic == ARENA_PENDING_MAGIC)
+            ((ARENA_INUSE *)ptr - 1)->magic == ARENA_PENDING_MAGIC ||
+            ((ARENA_INUSE *)ptr - 1)->magic == ARENA_LFH_MAGIC)
         {
             ARENA_INUSE *pArena = (ARENA_INUSE *)ptr - 1;
             ptr += pArena->size & ARENA_SIZE_MASK;
@@ -2319,7 +2445,7 @@ NTSTATUS WINAPI RtlWalkHeap( HANDLE heap, PVOID entry_ptr )
         entry->lpData = pArena + 1;
         entry->cbData = pArena->size & ARENA_SIZE_MASK;
         entry->cbOverhead = sizeof(ARENA_INUSE);
-        entry->wFlags = (pArena->magic == ARENA_PENDING_MAGIC) ?
+        entry->wFlags = (pArena->magic == ARENA_PENDING_MAGIC || pArena->magic == ARENA_LFH_MAGIC) ?
                         PROCESS_HEAP_UNCOMMITTED_RANGE : PROCESS_HEAP_ENTRY_BUSY;
         /* FIXME: can't handle PROCESS_HEAP_ENTRY_MOVEABLE
         and PROCESS_HEAP_ENTRY_DDESHARE yet */
@@ -2384,6 +2510,8 @@ ULONG WINAPI RtlGetProcessHeaps( ULONG count, HANDLE *heaps )
 NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS info_class,
                                          PVOID info, SIZE_T size_in, PSIZE_T size_out)
 {
+    HEAP *heapPtr;
+
     switch (info_class)
     {
     case HeapCompatibilityInformation:
@@ -2392,7 +2520,8 @@ NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS inf
         if (size_in < sizeof(ULONG))
             return STATUS_BUFFER_TOO_SMALL;
 
-        *(ULONG *)info = 0; /* standard heap */
+        if (!(heapPtr = HEAP_GetPtr( heap ))) return STATUS_INVALID_HANDLE;
+        *(ULONG *)info = heapPtr->compat_info;
         return STATUS_SUCCESS;
 
     default:
@@ -2406,6 +2535,28 @@ NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS inf
  */
 NTSTATUS WINAPI RtlSetHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS info_class, PVOID info, SIZE_T size)
 {
-    FIXME("%p %d %p %ld stub\n", heap, info_class, info, size);
-    return STATUS_SUCCESS;
+    HEAP *heapPtr;
+
+    switch (info_class)
+    {
+    case HeapCompatibilityInformation:
+        if (size < sizeof(ULONG)) return STATUS_BUFFER_TOO_SMALL;
+        if (!(heapPtr = HEAP_GetPtr( heap ))) return STATUS_INVALID_HANDLE;
+
+        switch (*(ULONG *)info)
+        {
+        case HEAP_STD:
+            /* the LFH cannot be disabled once it is enabled */
+            return heapPtr->compat_info == HEAP_STD ? STATUS_SUCCESS : STATUS_UNSUCCESSFUL;
+        case HEAP_LFH:
+            return enable_lfh( heapPtr );
+        default:
+            /* look-aside lists are not supported anymore since Vista */
+            return STATUS_UNSUCCESSFUL;
+        }
+
+    default:
+        FIXME("%p %d %p %ld stub\n", heap, info_class, info, size);
+        return STATUS_SUCCESS;
+    }
 }
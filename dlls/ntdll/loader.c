@@ -2015,6 +2015,9 @@ static void load_builtin_callback( void *module, const char *filename )
             RemoveEntryList(&wm->ldr.InLoadOrderModuleList);
             RemoveEntryList(&wm->ldr.InMemoryOrderModuleList);
             RemoveEntryList(&wm->ldr.HashLinks);
+#if defined(__x86_64__) || defined(__arm__) || defined(__aarch64__)
+            flush_function_table_cache( wm->ldr.BaseAddress );
+#endif
             /* FIXME: free the modref */
             builtin_load_info->status = STATUS_DLL_NOT_FOUND;
             return;
@@ -2666,6 +2669,9 @@ static NTSTATUS load_native_dll( LPCWSTR load_path, const UNICODE_STRING *nt_nam
             RemoveEntryList(&wm->ldr.InLoadOrderModuleList);
             RemoveEntryList(&wm->ldr.InMemoryOrderModuleList);
             RemoveEntryList(&wm->ldr.HashLinks);
+#if defined(__x86_64__) || defined(__arm__) || defined(__aarch64__)
+            flush_function_table_cache( wm->ldr.BaseAddress );
+#endif
 
             /* FIXME: there are several more dangling references
              * left. Including dlls loaded by this dll before the
@@ -3775,6 +3781,7 @@ void WINAPI LdrShutdownProcess(void)
     TRACE("()\n");
     process_detaching = TRUE;
     process_detach();
+    server_dump_call_stats();
 }
 
 
@@ -3849,6 +3856,9 @@ static void free_modref( WINE_MODREF *wm )
     RemoveEntryList(&wm->ldr.HashLinks);
     if (wm->ldr.InInitializationOrderModuleList.Flink)
         RemoveEntryList(&wm->ldr.InInitializationOrderModuleList);
+#if defined(__x86_64__) || defined(__arm__) || defined(__aarch64__)
+    flush_function_table_cache( wm->ldr.BaseAddress );
+#endif
 
     TRACE(" unloading %s\n", debugstr_w(wm->ldr.FullDllName.Buffer));
     if (!TRACE_ON(module))
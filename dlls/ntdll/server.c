@@ -38,6 +38,7 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 #include <sys/types.h>
 #ifdef HAVE_SYS_SOCKET_H
 # include <sys/socket.h>
@@ -294,23 +295,113 @@ static void read_reply_data( void *buffer, size_t size )
  */
 static inline unsigned int wait_reply( struct __server_request_info *req )
 {
-    read_reply_data( &req->u.reply, sizeof(req->u.reply) );
-    if (req->u.reply.reply_header.reply_size)
-        read_reply_data( req->reply_data, req->u.reply.reply_header.reply_size );
+    data_size_t max_size = req->u.req.request_header.reply_size;
+    struct iovec vec[2];
+    int ret;
+
+    /* fetch the reply header and data with a single read in the common case */
+    vec[0].iov_base = &req->u.reply;
+    vec[0].iov_len  = sizeof(req->u.reply);
+    vec[1].iov_base = req->reply_data;
+    vec[1].iov_len  = max_size;
+
+    for (;;)
+    {
+        if ((ret = readv( ntdll_get_thread_data()->reply_fd, vec, max_size ? 2 : 1 )) > 0) break;
+        if (!ret) abort_thread(0);  /* the server closed the connection */
+        if (errno == EINTR) continue;
+        if (errno == EPIPE) abort_thread(0);
+        server_protocol_perror("read");
+    }
+
+    if (ret < (int)sizeof(req->u.reply))
+    {
+        read_reply_data( (char *)&req->u.reply + ret, sizeof(req->u.reply) - ret );
+        ret = 0;
+    }
+    else ret -= sizeof(req->u.reply);
+
+    if (req->u.reply.reply_header.reply_size > (data_size_t)ret)
+        read_reply_data( (char *)req->reply_data + ret, req->u.reply.reply_header.reply_size - ret );
     return req->u.reply.reply_header.error;
 }
 
 
+/* server call latency histogram, only maintained when +server tracing is enabled */
+#define CALL_HISTOGRAM_BUCKETS 16
+
+static int call_histogram[REQ_NB_REQUESTS][CALL_HISTOGRAM_BUCKETS];
+
+static inline ULONGLONG call_timestamp(void)
+{
+#ifdef HAVE_CLOCK_GETTIME
+    struct timespec ts;
+
+    if (!clock_gettime( CLOCK_MONOTONIC, &ts )) return ts.tv_sec * (ULONGLONG)1000000000 + ts.tv_nsec;
+#endif
+    return 0;
+}
+
+/* bucket 0 counts calls below 1us, bucket n calls below 2^n us, the last one everything above */
+static void record_call_time( enum request req, ULONGLONG ns )
+{
+    unsigned int bucket = 0;
+    ULONGLONG us = ns / 1000;
+
+    if (req >= REQ_NB_REQUESTS) return;
+    while (us && bucket < CALL_HISTOGRAM_BUCKETS - 1)
+    {
+        us >>= 1;
+        bucket++;
+    }
+    interlocked_xchg_add( &call_histogram[req][bucket], 1 );
+}
+
+
+/***********************************************************************
+ *           server_dump_call_stats
+ *
+ * Dump the server call latency histogram; called at process exit.
+ */
+void server_dump_call_stats(void)
+{
+    unsigned int req, i;
+
+    if (!TRACE_ON(server)) return;
+
+    for (req = 0; req < REQ_NB_REQUESTS; req++)
+    {
+        char buffer[CALL_HISTOGRAM_BUCKETS * 24], *p = buffer;
+        int total = 0;
+
+        for (i = 0; i < CALL_HISTOGRAM_BUCKETS; i++)
+        {
+            if (!call_histogram[req][i]) continue;
+            total += call_histogram[req][i];
+            if (i == CALL_HISTOGRAM_BUCKETS - 1)
+                p += sprintf( p, " >=%uus:%d", 1u << (i - 1), call_histogram[req][i] );
+            else
+                p += sprintf( p, " <%uus:%d", 1u << i, call_histogram[req][i] );
+        }
+        if (total) TRACE( "req %u: %d calls%s\n", req, total, buffer );
+    }
+}
+
+
 /***********************************************************************
  *           server_call_unlocked
  */
 unsigned int server_call_unlocked( void *req_ptr )
 {
     struct __server_request_info * const req = req_ptr;
+    enum request code = req->u.req.request_header.req;
+    ULONGLONG start = 0;
     unsigned int ret;
 
-    if ((ret = send_request( req ))) return ret;
-    return wait_reply( req );
+    if (TRACE_ON(server)) start = call_timestamp();
+    if (!(ret = send_request( req ))) ret = wait_reply( req );
+    if (start) record_call_time( code, call_timestamp() - start );
+    return ret;
 }
 
 
@@ -265,8 +265,12 @@ NTSTATUS WINAPI NtCreateSemaphore( OUT PHANDLE SemaphoreHandle,
     if (do_fsync())
         return fsync_create_semaphore( SemaphoreHandle, access, attr, InitialCount, MaximumCount );
 
+    /* fall back to server objects when we run out of eventfds */
     if (do_esync())
-        return esync_create_semaphore( SemaphoreHandle, access, attr, InitialCount, MaximumCount );
+    {
+        ret = esync_create_semaphore( SemaphoreHandle, access, attr, InitialCount, MaximumCount );
+        if (ret != STATUS_TOO_MANY_OPENED_FILES && ret != STATUS_OBJECT_TYPE_MISMATCH) return ret;
+    }
 
     if ((ret = alloc_object_attributes( attr, &objattr, &len ))) return ret;
 
@@ -298,7 +302,10 @@ NTSTATUS WINAPI NtOpenSemaphore( HANDLE *handle, ACCESS_MASK access, const OBJEC
         return fsync_open_semaphore( handle, access, attr );
 
     if (do_esync())
-        return esync_open_semaphore( handle, access, attr );
+    {
+        ret = esync_open_semaphore( handle, access, attr );
+        if (ret != STATUS_OBJECT_TYPE_MISMATCH) return ret;
+    }
 
     SERVER_START_REQ( open_semaphore )
     {
@@ -327,7 +334,10 @@ NTSTATUS WINAPI NtQuerySemaphore( HANDLE handle, SEMAPHORE_INFORMATION_CLASS cla
         return fsync_query_semaphore( handle, class, info, len, ret_len );
 
     if (do_esync())
-        return esync_query_semaphore( handle, class, info, len, ret_len );
+    {
+        ret = esync_query_semaphore( handle, class, info, len, ret_len );
+        if (ret != STATUS_NOT_IMPLEMENTED) return ret;
+    }
 
     TRACE("(%p, %u, %p, %u, %p)\n", handle, class, info, len, ret_len);
 
@@ -365,7 +375,10 @@ NTSTATUS WINAPI NtReleaseSemaphore( HANDLE handle, ULONG count, PULONG previous
         return fsync_release_semaphore( handle, count, previous );
 
     if (do_esync())
-        return esync_release_semaphore( handle, count, previous );
+    {
+        ret = esync_release_semaphore( handle, count, previous );
+        if (ret != STATUS_NOT_IMPLEMENTED) return ret;
+    }
 
     SERVER_START_REQ( release_semaphore )
     {
@@ -399,7 +412,10 @@ NTSTATUS WINAPI NtCreateEvent( PHANDLE EventHandle, ACCESS_MASK DesiredAccess,
         return fsync_create_event( EventHandle, DesiredAccess, attr, type, InitialState );
 
     if (do_esync())
-        return esync_create_event( EventHandle, DesiredAccess, attr, type, InitialState );
+    {
+        ret = esync_create_event( EventHandle, DesiredAccess, attr, type, InitialState );
+        if (ret != STATUS_TOO_MANY_OPENED_FILES && ret != STATUS_OBJECT_TYPE_MISMATCH) return ret;
+    }
 
     if ((ret = alloc_object_attributes( attr, &objattr, &len ))) return ret;
 
@@ -432,7 +448,10 @@ NTSTATUS WINAPI NtOpenEvent( HANDLE *handle, ACCESS_MASK access, const OBJECT_AT
         return fsync_open_event( handle, access, attr );
 
     if (do_esync())
-        return esync_open_event( handle, access, attr );
+    {
+        ret = esync_open_event( handle, access, attr );
+        if (ret != STATUS_OBJECT_TYPE_MISMATCH) return ret;
+    }
 
     SERVER_START_REQ( open_event )
     {
@@ -461,7 +480,10 @@ NTSTATUS WINAPI NtSetEvent( HANDLE handle, LONG *prev_state )
         return fsync_set_event( handle, prev_state );
 
     if (do_esync())
-        return esync_set_event( handle, prev_state );
+    {
+        ret = esync_set_event( handle, prev_state );
+        if (ret != STATUS_NOT_IMPLEMENTED) return ret;
+    }
 
     SERVER_START_REQ( event_op )
     {
@@ -485,7 +507,10 @@ NTSTATUS WINAPI NtResetEvent( HANDLE handle, LONG *prev_state )
         return fsync_reset_event( handle, prev_state );
 
     if (do_esync())
-        return esync_reset_event( handle, prev_state );
+    {
+        ret = esync_reset_event( handle, prev_state );
+        if (ret != STATUS_NOT_IMPLEMENTED) return ret;
+    }
 
     SERVER_START_REQ( event_op )
     {
@@ -523,7 +548,10 @@ NTSTATUS WINAPI NtPulseEvent( HANDLE handle, LONG *prev_state )
         return fsync_pulse_event( handle, prev_state );
 
     if (do_esync())
-        return esync_pulse_event( handle, prev_state );
+    {
+        ret = esync_pulse_event( handle, prev_state );
+        if (ret != STATUS_NOT_IMPLEMENTED) return ret;
+    }
 
     SERVER_START_REQ( event_op )
     {
@@ -549,7 +577,10 @@ NTSTATUS WINAPI NtQueryEvent( HANDLE handle, EVENT_INFORMATION_CLASS class,
         return fsync_query_event( handle, class, info, len, ret_len );
 
     if (do_esync())
-        return esync_query_event( handle, class, info, len, ret_len );
+    {
+        ret = esync_query_event( handle, class, info, len, ret_len );
+        if (ret != STATUS_NOT_IMPLEMENTED) return ret;
+    }
 
     TRACE("(%p, %u, %p, %u, %p)\n", handle, class, info, len, ret_len);
 
@@ -598,7 +629,10 @@ NTSTATUS WINAPI NtCreateMutant(OUT HANDLE* MutantHandle,
         return fsync_create_mutex( MutantHandle, access, attr, InitialOwner );
 
     if (do_esync())
-        return esync_create_mutex( MutantHandle, access, attr, InitialOwner );
+    {
+        status = esync_create_mutex( MutantHandle, access, attr, InitialOwner );
+        if (status != STATUS_TOO_MANY_OPENED_FILES && status != STATUS_OBJECT_TYPE_MISMATCH) return status;
+    }
 
     if ((status = alloc_object_attributes( attr, &objattr, &len ))) return status;
 
@@ -630,7 +664,10 @@ NTSTATUS WINAPI NtOpenMutant( HANDLE *handle, ACCESS_MASK access, const OBJECT_A
         return fsync_open_mutex( handle, access, attr );
 
     if (do_esync())
-        return esync_open_mutex( handle, access, attr );
+    {
+        status = esync_open_mutex( handle, access, attr );
+        if (status != STATUS_OBJECT_TYPE_MISMATCH) return status;
+    }
 
     SERVER_START_REQ( open_mutex )
     {
@@ -658,7 +695,10 @@ NTSTATUS WINAPI NtReleaseMutant( IN HANDLE handle, OUT PLONG prev_count OPTIONAL
         return fsync_release_mutex( handle, prev_count );
 
     if (do_esync())
-        return esync_release_mutex( handle, prev_count );
+    {
+        status = esync_release_mutex( handle, prev_count );
+        if (status != STATUS_NOT_IMPLEMENTED) return status;
+    }
 
     SERVER_START_REQ( release_mutex )
     {
@@ -684,7 +724,10 @@ NTSTATUS WINAPI NtQueryMutant( HANDLE handle, MUTANT_INFORMATION_CLASS class,
         return fsync_query_mutex( handle, class, info, len, ret_len );
 
     if (do_esync())
-        return esync_query_mutex( handle, class, info, len, ret_len );
+    {
+        ret = esync_query_mutex( handle, class, info, len, ret_len );
+        if (ret != STATUS_NOT_IMPLEMENTED) return ret;
+    }
 
     TRACE("(%p, %u, %p, %u, %p)\n", handle, class, info, len, ret_len);
 
@@ -1516,31 +1559,37 @@ NTSTATUS WINAPI NtRemoveIoCompletion( HANDLE CompletionPort, PULONG_PTR Completi
 NTSTATUS WINAPI NtRemoveIoCompletionEx( HANDLE port, FILE_IO_COMPLETION_INFORMATION *info, ULONG count,
                                         ULONG *written, LARGE_INTEGER *timeout, BOOLEAN alertable )
 {
+    struct completion_msg msgs[64];
     NTSTATUS ret;
-    ULONG i = 0;
+    ULONG i = 0, j, n, max;
 
     TRACE("%p %p %u %p %p %u\n", port, info, count, written, timeout, alertable);
 
     for (;;)
     {
+        /* fetch the queued completions in batches rather than one server call per packet */
         while (i < count)
         {
-            SERVER_START_REQ( remove_completion )
+            max = min( count - i, ARRAY_SIZE(msgs) );
+            SERVER_START_REQ( remove_completions )
             {
                 req->handle = wine_server_obj_handle( port );
-                if (!(ret = wine_server_call( req )))
-                {
-                    info[i].CompletionKey             = reply->ckey;
-                    info[i].CompletionValue           = reply->cvalue;
-                    info[i].IoStatusBlock.Information = reply->information;
-                    info[i].IoStatusBlock.u.Status    = reply->status;
-                }
+                wine_server_set_reply( req, msgs, max * sizeof(msgs[0]) );
+                ret = wine_server_call( req );
+                n = wine_server_reply_size( reply ) / sizeof(msgs[0]);
             }
             SERVER_END_REQ;
 
             if (ret != STATUS_SUCCESS) break;
 
-            ++i;
+            for (j = 0; j < n; j++, i++)
+            {
+                info[i].CompletionKey             = msgs[j].ckey;
+                info[i].CompletionValue           = msgs[j].cvalue;
+                info[i].IoStatusBlock.Information = msgs[j].information;
+                info[i].IoStatusBlock.u.Status    = msgs[j].status;
+            }
+            if (n < max) break;  /* no more queued completions */
         }
 
         if (i || ret != STATUS_PENDING)
@@ -2317,6 +2366,23 @@ BOOLEAN WINAPI RtlTryAcquireSRWLockShared( RTL_SRWLOCK *lock )
 }
 
 #ifdef __linux__
+/* The futex value of a condition variable is a sequence number incremented
+ * by two on every wake. The low bit is set by sleeping threads, so that the
+ * wake functions can skip the syscall when nobody ever waited on it. */
+#define CV_FUTEX_WAITERS_BIT    1
+#define CV_FUTEX_SEQ_INC        2
+
+/* mark the condition variable as waited on; returns FALSE if it has been
+ * woken since val was read */
+static BOOL fast_mark_cv_waiters( int *futex, int *val )
+{
+    int old = *val;
+
+    if (old & CV_FUTEX_WAITERS_BIT) return TRUE;
+    *val = old | CV_FUTEX_WAITERS_BIT;
+    return interlocked_cmpxchg( futex, *val, old ) == old;
+}
+
 static NTSTATUS fast_wait_cv( int *futex, int val, const LARGE_INTEGER *timeout )
 {
     struct timespec timespec;
@@ -2348,6 +2414,8 @@ static NTSTATUS fast_sleep_cs_cv( RTL_CONDITION_VARIABLE *variable,
         return STATUS_NOT_IMPLEMENTED;
 
     val = *futex;
+    if (!fast_mark_cv_waiters( futex, &val ))
+        return STATUS_WAIT_0;
 
     RtlLeaveCriticalSection( cs );
     status = fast_wait_cv( futex, val, timeout );
@@ -2368,6 +2436,8 @@ static NTSTATUS fast_sleep_srw_cv( RTL_CONDITION_VARIABLE *variable,
         return STATUS_NOT_IMPLEMENTED;
 
     val = *futex;
+    if (!fast_mark_cv_waiters( futex, &val ))
+        return STATUS_WAIT_0;
 
     if (flags & RTL_CONDITION_VARIABLE_LOCKMODE_SHARED)
         RtlReleaseSRWLockShared( lock );
@@ -2385,15 +2455,24 @@ static NTSTATUS fast_sleep_srw_cv( RTL_CONDITION_VARIABLE *variable,
 
 static NTSTATUS fast_wake_cv( RTL_CONDITION_VARIABLE *variable, int count )
 {
-    int *futex;
+    int old, new, *futex;
 
     if (!use_futexes()) return STATUS_NOT_IMPLEMENTED;
 
     if (!(futex = get_futex( &variable->Ptr )))
         return STATUS_NOT_IMPLEMENTED;
 
-    interlocked_xchg_add( futex, 1 );
-    futex_wake( futex, count );
+    /* Waking a single thread has to leave the waiters bit set, as others may
+     * still be sleeping. Waking all of them clears it. */
+    do
+    {
+        old = *futex;
+        new = (int)((unsigned int)old + CV_FUTEX_SEQ_INC);
+        if (count == INT_MAX) new &= ~CV_FUTEX_WAITERS_BIT;
+    } while (interlocked_cmpxchg( futex, new, old ) != old);
+
+    if (old & CV_FUTEX_WAITERS_BIT)
+        futex_wake( futex, count );
     return STATUS_SUCCESS;
 }
 #else
@@ -1966,17 +1966,26 @@ static void tp_object_prio_queue( struct threadpool_object *object )
 static void tp_object_submit( struct threadpool_object *object, BOOL signaled )
 {
     struct threadpool *pool = object->pool;
-    NTSTATUS status = STATUS_UNSUCCESSFUL;
+    BOOL new_worker = FALSE, wake_worker;
+    NTSTATUS status;
+    HANDLE thread;
 
     assert( !object->shutdown );
     assert( !pool->shutdown );
 
     enter_critical_section( &pool->cs );
 
-    /* Start new worker threads if required. */
+    /* Reserve a new worker thread if required. The thread itself is created
+     * after leaving the critical section, so that other submitters and the
+     * workers are not blocked by the server round trip. */
     if (pool->num_busy_workers >= pool->num_workers &&
         pool->num_workers < pool->max_workers)
-        status = tp_new_worker_thread( pool );
+    {
+        interlocked_inc( &pool->refcount );
+        pool->num_workers++;
+        pool->num_busy_workers++;
+        new_worker = TRUE;
+    }
 
     /* Queue work item and increment refcount. */
     interlocked_inc( &object->refcount );
@@ -1987,14 +1996,36 @@ static void tp_object_submit( struct threadpool_object *object, BOOL signaled )
     if (object->type == TP_OBJECT_TYPE_WAIT && signaled)
         object->u.wait.signaled++;
 
-    /* No new thread started - wake up one existing thread. */
-    if (status != STATUS_SUCCESS)
+    /* Only wake up an existing thread if one of them is idle. */
+    wake_worker = !new_worker && pool->num_busy_workers < pool->num_workers;
+
+    leave_critical_section( &pool->cs );
+
+    if (new_worker)
     {
+        status = RtlCreateUserThread( GetCurrentProcess(), NULL, FALSE, NULL, 0, 0,
+                                      threadpool_worker_proc, pool, &thread, NULL );
+        if (status == STATUS_SUCCESS)
+        {
+            NtClose( thread );
+            return;
+        }
+
+        /* No new thread started - release the reservation. */
+        enter_critical_section( &pool->cs );
+        pool->num_workers--;
+        pool->num_busy_workers--;
         assert( pool->num_workers > 0 );
-        RtlWakeConditionVariable( &pool->update_event );
+        wake_worker = pool->num_busy_workers < pool->num_workers;
+        leave_critical_section( &pool->cs );
+        interlocked_dec( &pool->refcount );
     }
 
-    leave_critical_section( &pool->cs );
+    /* No new thread started - wake up one existing thread. The sleeping
+     * workers check the queue with the lock held, so this is safe to do
+     * after the lock has been released. */
+    if (wake_worker)
+        RtlWakeConditionVariable( &pool->update_event );
 }
 
 /***********************************************************************
@@ -130,6 +130,20 @@ static inline ULONGLONG monotonic_counter(void)
     return now.tv_sec * (ULONGLONG)TICKSPERSEC + now.tv_usec * 10 + TICKS_1601_TO_1970 - server_start_time;
 }
 
+/* return a monotonic time counter with only millisecond accuracy, in Win32 ticks */
+static inline ULONGLONG monotonic_counter_coarse(void)
+{
+#if defined(HAVE_CLOCK_GETTIME) && defined(CLOCK_MONOTONIC_COARSE)
+    struct timespec ts;
+
+    /* the coarse clock is always served by the vDSO without reading the
+     * hardware clock source, and its resolution is a kernel tick */
+    if (!clock_gettime( CLOCK_MONOTONIC_COARSE, &ts ))
+        return ts.tv_sec * (ULONGLONG)TICKSPERSEC + ts.tv_nsec / 100;
+#endif
+    return monotonic_counter();
+}
+
 /******************************************************************************
  *       RtlTimeToTimeFields [NTDLL.@]
  *
@@ -580,7 +594,7 @@ BOOL WINAPI DECLSPEC_HOTPATCH RtlQueryPerformanceFrequency( LARGE_INTEGER *frequ
  */
 ULONG WINAPI NtGetTickCount(void)
 {
-    return monotonic_counter() / TICKSPERMSEC;
+    return monotonic_counter_coarse() / TICKSPERMSEC;
 }
 
 /* calculate the mday of dst change date, so that for instance Sun 5 Oct 2007
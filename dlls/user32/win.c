@@ -2309,6 +2309,37 @@ UINT WINAPI GetDpiForWindow( HWND hwnd )
 }
 
 
+/* read the styles of a window from the server shared memory, if available */
+static BOOL get_shm_window_styles( HWND hwnd, DWORD *style, DWORD *ex_style )
+{
+    shmglobal_t *shm = wine_get_shmglobal();
+    user_handle_t handle = wine_server_user_handle( hwnd );
+    unsigned int index = (LOWORD(handle) - FIRST_USER_HANDLE) >> 1;
+    const shmwindow_t *win;
+    user_handle_t full_handle;
+    unsigned int seq;
+
+    if (!shm || LOWORD(handle) < FIRST_USER_HANDLE || index >= SHM_WINDOW_COUNT) return FALSE;
+    win = &shm->windows[index];
+
+    for (;;)
+    {
+        seq = __atomic_load_n( &win->seq, __ATOMIC_ACQUIRE );
+        if (seq & 1) continue;  /* update in progress */
+        full_handle = win->handle;
+        *style      = win->style;
+        *ex_style   = win->ex_style;
+        __atomic_thread_fence( __ATOMIC_ACQUIRE );
+        if (__atomic_load_n( &win->seq, __ATOMIC_RELAXED ) == seq) break;
+    }
+
+    if (!full_handle) return FALSE;
+    if (full_handle == handle) return TRUE;
+    /* a handle without generation matches any window at that index */
+    return LOWORD(full_handle) == LOWORD(handle) && (!HIWORD(handle) || HIWORD(handle) == 0xffff);
+}
+
+
 /**********************************************************************
  *	     WIN_GetWindowLong
  *
@@ -2356,11 +2387,16 @@ static LONG_PTR WIN_GetWindowLong( HWND hwnd, INT offset, UINT size, BOOL unicod
 
     if (wndPtr == WND_OTHER_PROCESS)
     {
+        DWORD style, ex_style;
+
         if (offset == GWLP_WNDPROC)
         {
             SetLastError( ERROR_ACCESS_DENIED );
             return 0;
         }
+        if ((offset == GWL_STYLE || offset == GWL_EXSTYLE) && get_shm_window_styles( hwnd, &style, &ex_style ))
+            return offset == GWL_STYLE ? style : ex_style;
+
         SERVER_START_REQ( set_window_info )
         {
             req->handle = wine_server_user_handle( hwnd );
@@ -1198,6 +1198,23 @@ static DWORD sock_is_blocking(SOCKET s, BOOL *ret)
     return err;
 }
 
+/* re-enable an event and check whether the socket is blocking in a single server call */
+static DWORD _enable_event_is_blocking( SOCKET s, unsigned int event, BOOL *ret )
+{
+    DWORD err;
+    SERVER_START_REQ( enable_socket_event )
+    {
+        req->handle = wine_server_obj_handle( SOCKET2HANDLE(s) );
+        req->mask   = event;
+        req->sstate = 0;
+        req->cstate = 0;
+        err = NtStatusToWSAError( wine_server_call( req ));
+        *ret = (reply->state & FD_WINE_NONBLOCKING) == 0;
+    }
+    SERVER_END_REQ;
+    return err;
+}
+
 static DWORD _get_connect_time(SOCKET s)
 {
     NTSTATUS status;
@@ -5287,13 +5304,33 @@ int WINAPI WS_recvfrom(SOCKET s, char *buf, INT len, int flags,
         return n;
 }
 
+/* get the per-thread pollfd array, making sure it can hold count descriptors */
+static struct pollfd *get_poll_fd_cache( unsigned int count )
+{
+    struct per_thread_data *ptb = get_per_thread_data();
+    struct pollfd *fds;
+
+    /* check if the cache can hold all descriptors, if not do the resizing */
+    if (ptb->fd_count < count)
+    {
+        if (!(fds = HeapAlloc(GetProcessHeap(), 0, count * sizeof(fds[0]))))
+        {
+            SetLastError( ERROR_NOT_ENOUGH_MEMORY );
+            return NULL;
+        }
+        HeapFree(GetProcessHeap(), 0, ptb->fd_cache);
+        ptb->fd_cache = fds;
+        ptb->fd_count = count;
+    }
+    return ptb->fd_cache;
+}
+
 /* allocate a poll array for the corresponding fd sets */
 static struct pollfd *fd_sets_to_poll( const WS_fd_set *readfds, const WS_fd_set *writefds,
                                        const WS_fd_set *exceptfds, int *count_ptr )
 {
     unsigned int i, j = 0, count = 0;
     struct pollfd *fds;
-    struct per_thread_data *ptb = get_per_thread_data();
 
     if (readfds) count += readfds->fd_count;
     if (writefds) count += writefds->fd_count;
@@ -5305,80 +5342,34 @@ static struct pollfd *fd_sets_to_poll( const WS_fd_set *readfds, const WS_fd_set
         return NULL;
     }
 
-    /* check if the cache can hold all descriptors, if not do the resizing */
-    if (ptb->fd_count < count)
-    {
-        if (!(fds = HeapAlloc(GetProcessHeap(), 0, count * sizeof(fds[0]))))
-        {
-            SetLastError( ERROR_NOT_ENOUGH_MEMORY );
-            return NULL;
-        }
-        HeapFree(GetProcessHeap(), 0, ptb->fd_cache);
-        ptb->fd_cache = fds;
-        ptb->fd_count = count;
-    }
-    else
-        fds = ptb->fd_cache;
+    if (!(fds = get_poll_fd_cache( count ))) return NULL;
 
+    /* The checks for sockets that select ignores (unbound sockets and the like) are
+     * done in check_poll_fds, only for sockets that poll reports, so that waiting on
+     * a large number of idle sockets doesn't cost several syscalls per socket. */
     if (readfds)
         for (i = 0; i < readfds->fd_count; i++, j++)
         {
             fds[j].fd = get_sock_fd( readfds->fd_array[i], FILE_READ_DATA, NULL );
             if (fds[j].fd == -1) goto failed;
+            fds[j].events = POLLIN;
             fds[j].revents = 0;
-            if (is_fd_bound(fds[j].fd, NULL, NULL) == 1)
-            {
-                fds[j].events = POLLIN;
-            }
-            else
-            {
-                release_sock_fd( readfds->fd_array[i], fds[j].fd );
-                fds[j].fd = -1;
-                fds[j].events = 0;
-            }
         }
     if (writefds)
         for (i = 0; i < writefds->fd_count; i++, j++)
         {
             fds[j].fd = get_sock_fd( writefds->fd_array[i], FILE_WRITE_DATA, NULL );
             if (fds[j].fd == -1) goto failed;
+            fds[j].events = POLLOUT;
             fds[j].revents = 0;
-            if (is_fd_bound(fds[j].fd, NULL, NULL) == 1 ||
-                _get_fd_type(fds[j].fd) == SOCK_DGRAM)
-            {
-                fds[j].events = POLLOUT;
-            }
-            else
-            {
-                release_sock_fd( writefds->fd_array[i], fds[j].fd );
-                fds[j].fd = -1;
-                fds[j].events = 0;
-            }
         }
     if (exceptfds)
         for (i = 0; i < exceptfds->fd_count; i++, j++)
         {
             fds[j].fd = get_sock_fd( exceptfds->fd_array[i], 0, NULL );
             if (fds[j].fd == -1) goto failed;
+            fds[j].events = POLLHUP | POLLPRI;
             fds[j].revents = 0;
-            if (is_fd_bound(fds[j].fd, NULL, NULL) == 1)
-            {
-                int oob_inlined = 0;
-                socklen_t olen = sizeof(oob_inlined);
-
-                fds[j].events = POLLHUP;
-
-                /* Check if we need to test for urgent data or not */
-                getsockopt(fds[j].fd, SOL_SOCKET, SO_OOBINLINE, (char*) &oob_inlined, &olen);
-                if (!oob_inlined)
-                    fds[j].events |= POLLPRI;
-            }
-            else
-            {
-                release_sock_fd( exceptfds->fd_array[i], fds[j].fd );
-                fds[j].fd = -1;
-                fds[j].events = 0;
-            }
         }
     return fds;
 
@@ -5397,6 +5388,64 @@ failed:
     return NULL;
 }
 
+/* stop polling a socket that select should ignore */
+static void ignore_poll_fd( SOCKET s, struct pollfd *fd )
+{
+    release_sock_fd( s, fd->fd );
+    fd->fd = -1;
+    fd->events = 0;
+    fd->revents = 0;
+}
+
+/* check the sockets reported by poll, and ignore the ones that select doesn't wait on */
+/* returns the number of sockets that still have events */
+static int check_poll_fds( const WS_fd_set *readfds, const WS_fd_set *writefds,
+                           const WS_fd_set *exceptfds, struct pollfd *fds )
+{
+    unsigned int i, j = 0;
+    int ret = 0;
+
+    if (readfds)
+        for (i = 0; i < readfds->fd_count; i++, j++)
+        {
+            if (!fds[j].revents) continue;
+            if (is_fd_bound( fds[j].fd, NULL, NULL ) == 1) ret++;
+            else ignore_poll_fd( readfds->fd_array[i], &fds[j] );
+        }
+    if (writefds)
+        for (i = 0; i < writefds->fd_count; i++, j++)
+        {
+            if (!fds[j].revents) continue;
+            if (is_fd_bound( fds[j].fd, NULL, NULL ) == 1 || _get_fd_type( fds[j].fd ) == SOCK_DGRAM) ret++;
+            else ignore_poll_fd( writefds->fd_array[i], &fds[j] );
+        }
+    if (exceptfds)
+        for (i = 0; i < exceptfds->fd_count; i++, j++)
+        {
+            if (!fds[j].revents) continue;
+            if (is_fd_bound( fds[j].fd, NULL, NULL ) != 1)
+            {
+                ignore_poll_fd( exceptfds->fd_array[i], &fds[j] );
+                continue;
+            }
+            if (fds[j].revents & POLLPRI)
+            {
+                int oob_inlined = 0;
+                socklen_t olen = sizeof(oob_inlined);
+
+                /* urgent data is only reported when it isn't inlined */
+                getsockopt( fds[j].fd, SOL_SOCKET, SO_OOBINLINE, (char *)&oob_inlined, &olen );
+                if (oob_inlined)
+                {
+                    fds[j].events &= ~POLLPRI;
+                    fds[j].revents &= ~POLLPRI;
+                }
+            }
+            if (fds[j].revents) ret++;
+        }
+    return ret;
+}
+
 /* release the file descriptor obtained in fd_sets_to_poll */
 /* must be called with the original fd_set arrays, before calling get_poll_results */
 static void release_poll_fds( const WS_fd_set *readfds, const WS_fd_set *writefds,
@@ -5521,7 +5570,25 @@ int WINAPI WS_select(int nfds, WS_fd_set *ws_readfds,
     if (ws_timeout)
         timeout = (ws_timeout->tv_sec * 1000) + (ws_timeout->tv_usec + 999) / 1000;
 
-    ret = do_poll(pollfds, count, timeout);
+    for (;;)
+    {
+        DWORD start = GetTickCount();
+
+        ret = do_poll(pollfds, count, timeout);
+        if (ret <= 0 || check_poll_fds( ws_readfds, ws_writefds, ws_exceptfds, pollfds )) break;
+
+        /* only ignored sockets were reported, wait again for the remaining time */
+        if (timeout > 0)
+        {
+            DWORD elapsed = GetTickCount() - start;
+            timeout = (int)elapsed < timeout ? timeout - elapsed : 0;
+        }
+        if (!timeout)
+        {
+            ret = 0;
+            break;
+        }
+    }
     release_poll_fds( ws_readfds, ws_writefds, ws_exceptfds, pollfds );
 
     if (ret == -1) SetLastError(wsaErrno());
@@ -5548,7 +5615,7 @@ int WINAPI WSAPoll(WSAPOLLFD *wfds, ULONG count, int timeout)
         return SOCKET_ERROR;
     }
 
-    if (!(ufds = HeapAlloc(GetProcessHeap(), 0, count * sizeof(ufds[0]))))
+    if (!(ufds = get_poll_fd_cache( count )))
     {
         SetLastError(WSAENOBUFS);
         return SOCKET_ERROR;
@@ -5587,7 +5654,6 @@ int WINAPI WSAPoll(WSAPOLLFD *wfds, ULONG count, int timeout)
             wfds[i].revents = WS_POLLNVAL;
     }
 
-    HeapFree(GetProcessHeap(), 0, ufds);
     return ret;
 }
 
@@ -5756,7 +5822,12 @@ static int WS2_sendto( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
         return 0;
     }
 
-    if ((err = sock_is_blocking( s, &is_blocking ))) goto error;
+    if (n == totalLength)
+    {
+        /* everything was sent, blocking and non-blocking sockets behave the same */
+        is_blocking = FALSE;
+    }
+    else if ((err = _enable_event_is_blocking( s, FD_WRITE, &is_blocking ))) goto error;
 
     if ( is_blocking )
     {
@@ -5801,8 +5872,6 @@ static int WS2_sendto( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
     }
     else  /* non-blocking */
     {
-        if (n < totalLength)
-            _enable_event(SOCKET2HANDLE(s), FD_WRITE, 0, 0);
         if (n == -1)
         {
             err = WSAEWOULDBLOCK;
@@ -8218,7 +8287,10 @@ static int WS2_recv_base( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
 
         if (n != -1) break;
 
-        if ((err = sock_is_blocking( s, &is_blocking ))) goto error;
+        /* Blocking sockets can't have an event mask, so re-enabling FD_READ
+         * before waiting on them is harmless and saves a server call for
+         * non-blocking ones. */
+        if ((err = _enable_event_is_blocking( s, FD_READ, &is_blocking ))) goto error;
 
         if ( is_blocking )
         {
@@ -8239,15 +8311,12 @@ static int WS2_recv_base( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
 
             if (!poll_timeout || !poll( &pfd, 1, poll_timeout ))
             {
-                err = WSAETIMEDOUT;
-                /* a timeout is not fatal */
-                _enable_event(SOCKET2HANDLE(s), FD_READ, 0, 0);
+                err = WSAETIMEDOUT;  /* a timeout is not fatal */
                 goto error;
             }
         }
         else
         {
-            _enable_event(SOCKET2HANDLE(s), FD_READ, 0, 0);
             err = WSAEWOULDBLOCK;
             goto error;
         }
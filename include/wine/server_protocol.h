@@ -53,9 +53,20 @@ struct request_max_size
 #define FIRST_USER_HANDLE 0x0020
 #define LAST_USER_HANDLE  0xffef
 
+typedef struct
+{
+    unsigned int    seq;
+    user_handle_t   handle;
+    unsigned int    style;
+    unsigned int    ex_style;
+} shmwindow_t;
+
+#define SHM_WINDOW_COUNT ((LAST_USER_HANDLE - FIRST_USER_HANDLE + 1) >> 1)
+
 typedef struct
 {
     unsigned int last_input_time;
+    shmwindow_t  windows[SHM_WINDOW_COUNT];
 } shmglobal_t;
 
 typedef struct
@@ -1852,6 +1863,8 @@ struct enable_socket_event_request
 struct enable_socket_event_reply
 {
     struct reply_header __header;
+    unsigned int state;
+    char __pad_12[4];
 };
 
 struct set_socket_deferred_request
@@ -5640,6 +5653,28 @@ struct remove_completion_reply
 };
 
 
+struct completion_msg
+{
+    apc_param_t   ckey;
+    apc_param_t   cvalue;
+    apc_param_t   information;
+    unsigned int  status;
+    int           __pad;
+};
+
+
+struct remove_completions_request
+{
+    struct request_header __header;
+    obj_handle_t  handle;
+};
+struct remove_completions_reply
+{
+    struct reply_header __header;
+    /* VARARG(msgs,completion_msgs); */
+};
+
+
 
 struct query_completion_request
 {
@@ -5842,6 +5877,12 @@ enum fsync_type
     FSYNC_QUEUE,
 };
 
+/* The server publishes the fsync object behind each process handle in a
+ * per-process table, indexed like the handle table; each entry contains
+ * (shm_idx << FSYNC_HANDLE_MAP_TYPE_BITS) | type, or 0 if unknown. */
+#define FSYNC_HANDLE_MAP_ENTRIES   0x100000
+#define FSYNC_HANDLE_MAP_TYPE_BITS 3
+
 
 struct create_fsync_request
 {
@@ -5918,6 +5959,17 @@ struct get_fsync_apc_idx_reply
 };
 
 
+struct get_fsync_handle_map_request
+{
+    struct request_header __header;
+    char __pad_12[4];
+};
+struct get_fsync_handle_map_reply
+{
+    struct reply_header __header;
+};
+
+
 
 struct update_rawinput_devices_request
 {
@@ -6485,6 +6537,7 @@ enum request
     REQ_open_completion,
     REQ_add_completion,
     REQ_remove_completion,
+    REQ_remove_completions,
     REQ_query_completion,
     REQ_set_completion_info,
     REQ_add_fd_completion,
@@ -6502,6 +6555,7 @@ enum request
     REQ_get_fsync_idx,
     REQ_fsync_msgwait,
     REQ_get_fsync_apc_idx,
+    REQ_get_fsync_handle_map,
     REQ_update_rawinput_devices,
     REQ_get_rawinput_devices,
     REQ_get_suspend_context,
@@ -6813,6 +6867,7 @@ union generic_request
     struct open_completion_request open_completion_request;
     struct add_completion_request add_completion_request;
     struct remove_completion_request remove_completion_request;
+    struct remove_completions_request remove_completions_request;
     struct query_completion_request query_completion_request;
     struct set_completion_info_request set_completion_info_request;
     struct add_fd_completion_request add_fd_completion_request;
@@ -6830,6 +6885,7 @@ union generic_request
     struct get_fsync_idx_request get_fsync_idx_request;
     struct fsync_msgwait_request fsync_msgwait_request;
     struct get_fsync_apc_idx_request get_fsync_apc_idx_request;
+    struct get_fsync_handle_map_request get_fsync_handle_map_request;
     struct update_rawinput_devices_request update_rawinput_devices_request;
     struct get_rawinput_devices_request get_rawinput_devices_request;
     struct get_suspend_context_request get_suspend_context_request;
@@ -7139,6 +7195,7 @@ union generic_reply
     struct open_completion_reply open_completion_reply;
     struct add_completion_reply add_completion_reply;
     struct remove_completion_reply remove_completion_reply;
+    struct remove_completions_reply remove_completions_reply;
     struct query_completion_reply query_completion_reply;
     struct set_completion_info_reply set_completion_info_reply;
     struct add_fd_completion_reply add_fd_completion_reply;
@@ -7156,6 +7213,7 @@ union generic_reply
     struct get_fsync_idx_reply get_fsync_idx_reply;
     struct fsync_msgwait_reply fsync_msgwait_reply;
     struct get_fsync_apc_idx_reply get_fsync_apc_idx_reply;
+    struct get_fsync_handle_map_reply get_fsync_handle_map_reply;
     struct update_rawinput_devices_reply update_rawinput_devices_reply;
     struct get_rawinput_devices_reply get_rawinput_devices_reply;
     struct get_suspend_context_reply get_suspend_context_reply;
@@ -7177,6 +7235,6 @@ union generic_reply
     struct esync_msgwait_reply esync_msgwait_reply;
 };
 
-#define SERVER_PROTOCOL_VERSION 597
+#define SERVER_PROTOCOL_VERSION 601
 
 #endif /* __WINE_WINE_SERVER_PROTOCOL_H */
@@ -31,6 +31,9 @@
 #ifdef HAVE_SYS_MMAN_H
 # include <sys/mman.h>
 #endif
+#ifdef HAVE_SYS_RESOURCE_H
+# include <sys/resource.h>
+#endif
 #ifdef HAVE_SYS_STAT_H
 # include <sys/stat.h>
 #endif
@@ -102,6 +105,23 @@ void esync_init(void)
     if (ftruncate( shm_fd, shm_size ) == -1)
         perror( "ftruncate" );
 
+#ifdef RLIMIT_NOFILE
+    {
+        /* we hold an eventfd for every waitable object in the prefix,
+         * so raise the soft fd limit as far as we are allowed to */
+        struct rlimit rlimit;
+
+        if (!getrlimit( RLIMIT_NOFILE, &rlimit ) && rlimit.rlim_cur < rlimit.rlim_max)
+        {
+            rlimit.rlim_cur = rlimit.rlim_max;
+            if (setrlimit( RLIMIT_NOFILE, &rlimit ) == -1)
+                perror( "esync: setrlimit" );
+        }
+        if (debug_level && !getrlimit( RLIMIT_NOFILE, &rlimit ))
+            fprintf( stderr, "esync: fd limit is %lu\n", (unsigned long)rlimit.rlim_cur );
+    }
+#endif
+
     fprintf( stderr, "esync: up and running.\n" );
 
     atexit( shm_cleanup );
@@ -534,9 +554,8 @@ DECL_HANDLER(get_esync_fd)
     if (!(obj = get_handle_obj( current->process, req->handle, SYNCHRONIZE, NULL )))
         return;
 
-    if (obj->ops->get_esync_fd)
+    if (obj->ops->get_esync_fd && (fd = obj->ops->get_esync_fd( obj, &type )) != -1)
     {
-        fd = obj->ops->get_esync_fd( obj, &type );
         reply->type = type;
         if (obj->ops == &esync_ops)
         {
@@ -549,6 +568,8 @@ DECL_HANDLER(get_esync_fd)
     }
     else
     {
+        /* this includes objects whose eventfd couldn't be created because we
+         * ran out of fds; the client will fall back to server waits */
         if (debug_level)
         {
             fprintf( stderr, "%04x: esync: can't wait on object: ", current->id );
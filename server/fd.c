@@ -383,13 +383,19 @@ static file_pos_t max_unix_offset = OFF_T_MAX;
 
 struct timeout_user
 {
-    struct list           entry;      /* entry in sorted timeout list */
+    struct list           entry;      /* entry in expired timeouts list */
+    unsigned int          heap_pos;   /* position in timeout heap, or TIMEOUT_EXPIRED */
     timeout_t             when;       /* timeout expiry (absolute time) */
     timeout_callback      callback;   /* callback function */
     void                 *private;    /* callback private data */
 };
 
-static struct list timeout_list = LIST_INIT(timeout_list);   /* sorted timeouts list */
+#define TIMEOUT_EXPIRED (~0u)
+
+/* binary min-heap of pending timeouts, ordered by expiry time */
+static struct timeout_user **timeout_heap;
+static unsigned int timeout_count;
+static unsigned int timeout_heap_size;
 timeout_t current_time;
 
 static inline void set_current_time(void)
@@ -400,32 +406,86 @@ static inline void set_current_time(void)
     current_time = (timeout_t)now.tv_sec * TICKS_PER_SEC + now.tv_usec * 10 + ticks_1601_to_1970;
 }
 
+/* store a timeout at a given heap position */
+static inline void set_timeout_heap_pos( struct timeout_user *user, unsigned int pos )
+{
+    timeout_heap[pos] = user;
+    user->heap_pos = pos;
+}
+
+/* move a timeout up the heap until its parent expires before it */
+static void timeout_heap_up( struct timeout_user *user, unsigned int pos )
+{
+    while (pos)
+    {
+        unsigned int parent = (pos - 1) / 2;
+        if (timeout_heap[parent]->when <= user->when) break;
+        set_timeout_heap_pos( timeout_heap[parent], pos );
+        pos = parent;
+    }
+    set_timeout_heap_pos( user, pos );
+}
+
+/* move a timeout down the heap until its children expire after it */
+static void timeout_heap_down( struct timeout_user *user, unsigned int pos )
+{
+    for (;;)
+    {
+        unsigned int child = 2 * pos + 1;
+        if (child >= timeout_count) break;
+        if (child + 1 < timeout_count && timeout_heap[child + 1]->when < timeout_heap[child]->when) child++;
+        if (user->when <= timeout_heap[child]->when) break;
+        set_timeout_heap_pos( timeout_heap[child], pos );
+        pos = child;
+    }
+    set_timeout_heap_pos( user, pos );
+}
+
+/* remove a timeout from the heap */
+static void timeout_heap_remove( struct timeout_user *user )
+{
+    unsigned int pos = user->heap_pos;
+    struct timeout_user *last = timeout_heap[--timeout_count];
+
+    user->heap_pos = TIMEOUT_EXPIRED;
+    if (last == user) return;
+    if (pos && timeout_heap[(pos - 1) / 2]->when > last->when) timeout_heap_up( last, pos );
+    else timeout_heap_down( last, pos );
+}
+
 /* add a timeout user */
 struct timeout_user *add_timeout_user( timeout_t when, timeout_callback func, void *private )
 {
     struct timeout_user *user;
-    struct list *ptr;
+
+    if (timeout_count == timeout_heap_size)
+    {
+        unsigned int new_size = max( 64, timeout_heap_size * 2 );
+        struct timeout_user **new_heap = realloc( timeout_heap, new_size * sizeof(*new_heap) );
+
+        if (!new_heap)
+        {
+            set_error( STATUS_NO_MEMORY );
+            return NULL;
+        }
+        timeout_heap = new_heap;
+        timeout_heap_size = new_size;
+    }
 
     if (!(user = mem_alloc( sizeof(*user) ))) return NULL;
     user->when     = (when > 0) ? when : current_time - when;
     user->callback = func;
     user->private  = private;
 
-    /* Now insert it in the linked list */
-
-    LIST_FOR_EACH( ptr, &timeout_list )
-    {
-        struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
-        if (timeout->when >= user->when) break;
-    }
-    list_add_before( ptr, &user->entry );
+    timeout_heap_up( user, timeout_count++ );
     return user;
 }
 
 /* remove a timeout user */
 void remove_timeout_user( struct timeout_user *user )
 {
-    list_remove( &user->entry );
+    if (user->heap_pos == TIMEOUT_EXPIRED) list_remove( &user->entry );
+    else timeout_heap_remove( user );
     free( user );
 }
 
@@ -486,19 +546,76 @@ static inline void fd_poll_event( struct fd *fd, int event )
 
 static int epoll_fd = -1;
 
+struct epoll_user
+{
+    int events;   /* events currently registered with epoll */
+    int pending;  /* user is in the pending list */
+};
+
+static struct epoll_user *epoll_users;  /* epoll state, indexed like the pollfd array */
+static int *epoll_pending;              /* users whose registered events may be out of date */
+static int epoll_pending_count;
+static int epoll_users_size;
+
 static inline void init_epoll(void)
 {
     epoll_fd = epoll_create( 128 );
 }
 
+/* give up on epoll and fall back to the poll loop */
+static void close_epoll(void)
+{
+    close( epoll_fd );
+    epoll_fd = -1;
+}
+
+/* make sure the epoll state array covers the given user */
+static int grow_epoll_users( int user )
+{
+    struct epoll_user *new_users;
+    int *new_pending;
+    int new_size;
+
+    if (user < epoll_users_size) return 1;
+    new_size = max( allocated_users, user + 1 );
+    if (!(new_users = realloc( epoll_users, new_size * sizeof(*epoll_users) ))) return 0;
+    epoll_users = new_users;
+    if (!(new_pending = realloc( epoll_pending, new_size * sizeof(*epoll_pending) ))) return 0;
+    epoll_pending = new_pending;
+    memset( epoll_users + epoll_users_size, 0, (new_size - epoll_users_size) * sizeof(*epoll_users) );
+    epoll_users_size = new_size;
+    return 1;
+}
+
+static void do_epoll_ctl( int ctl, int unix_fd, int user, int events )
+{
+    struct epoll_event ev;
+
+    ev.events = events;
+    memset(&ev.data, 0, sizeof(ev.data));
+    ev.data.u32 = user;
+
+    if (epoll_ctl( epoll_fd, ctl, unix_fd, &ev ) == -1)
+    {
+        if (errno == ENOMEM) close_epoll();  /* not enough memory, give up on epoll */
+        else perror( "epoll_ctl" );  /* should not happen */
+    }
+    else epoll_users[user].events = events;
+}
+
 /* set the events that epoll waits for on this fd; helper for set_fd_events */
 static inline void set_fd_epoll_events( struct fd *fd, int user, int events )
 {
-    struct epoll_event ev;
     int ctl;
 
     if (epoll_fd == -1) return;
 
+    if (!grow_epoll_users( user ))
+    {
+        close_epoll();
+        return;
+    }
+
     if (events == -1)  /* stop waiting on this fd completely */
     {
         if (pollfd[user].fd == -1) return;  /* already removed */
@@ -511,23 +628,36 @@ static inline void set_fd_epoll_events( struct fd *fd, int user, int events )
     }
     else
     {
-        if (pollfd[user].events == events) return;  /* nothing to do */
-        ctl = EPOLL_CTL_MOD;
+        /* Changing the events of a registered fd is deferred until we are about
+         * to wait, so that an fd that is toggled several times while processing
+         * a request or a batch of events costs at most one epoll_ctl call. */
+        if (!epoll_users[user].pending)
+        {
+            epoll_users[user].pending = 1;
+            epoll_pending[epoll_pending_count++] = user;
+        }
+        return;
     }
 
-    ev.events = events;
-    memset(&ev.data, 0, sizeof(ev.data));
-    ev.data.u32 = user;
+    do_epoll_ctl( ctl, fd->unix_fd, user, events );
+}
+
+/* apply the deferred event changes before waiting */
+static void flush_epoll_events(void)
+{
+    int i;
 
-    if (epoll_ctl( epoll_fd, ctl, fd->unix_fd, &ev ) == -1)
+    for (i = 0; i < epoll_pending_count; i++)
     {
-        if (errno == ENOMEM)  /* not enough memory, give up on epoll */
-        {
-            close( epoll_fd );
-            epoll_fd = -1;
-        }
-        else perror( "epoll_ctl" );  /* should not happen */
+        int user = epoll_pending[i];
+
+        epoll_users[user].pending = 0;
+        if (epoll_fd == -1) continue;
+        if (pollfd[user].fd == -1) continue;  /* removed in the meantime */
+        if (pollfd[user].events == epoll_users[user].events) continue;  /* nothing to do */
+        do_epoll_ctl( EPOLL_CTL_MOD, pollfd[user].fd, user, pollfd[user].events );
     }
+    epoll_pending_count = 0;
 }
 
 static inline void remove_epoll_user( struct fd *fd, int user )
@@ -558,6 +688,8 @@ static inline void main_loop_epoll(void)
         timeout = get_next_timeout();
 
         if (!active_users) break;  /* last user removed by a timeout */
+
+        flush_epoll_events();
         if (epoll_fd == -1) break;  /* an error occurred with epoll */
 
         ret = epoll_wait( epoll_fd, events, ARRAY_SIZE( events ), timeout );
@@ -871,23 +1003,19 @@ static void remove_poll_user( struct fd *fd, int user )
 /* process pending timeouts and return the time until the next timeout, in milliseconds */
 static int get_next_timeout(void)
 {
-    if (!list_empty( &timeout_list ))
+    if (timeout_count)
     {
         struct list expired_list, *ptr;
 
-        /* first remove all expired timers from the list */
+        /* first remove all expired timers from the heap */
 
         list_init( &expired_list );
-        while ((ptr = list_head( &timeout_list )) != NULL)
+        while (timeout_count && timeout_heap[0]->when <= current_time)
         {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
+            struct timeout_user *timeout = timeout_heap[0];
 
-            if (timeout->when <= current_time)
-            {
-                list_remove( &timeout->entry );
-                list_add_tail( &expired_list, &timeout->entry );
-            }
-            else break;
+            timeout_heap_remove( timeout );
+            list_add_tail( &expired_list, &timeout->entry );
         }
 
         /* now call the callback for all the removed timers */
@@ -900,9 +1028,9 @@ static int get_next_timeout(void)
             free( timeout );
         }
 
-        if ((ptr = list_head( &timeout_list )) != NULL)
+        if (timeout_count)
         {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
+            struct timeout_user *timeout = timeout_heap[0];
             int diff = (timeout->when - current_time + 9999) / 10000;
             if (diff < 0) diff = 0;
             return diff;
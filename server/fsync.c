@@ -43,7 +43,9 @@
 #include "winternl.h"
 
 #include "handle.h"
+#include "process.h"
 #include "request.h"
+#include "file.h"
 #include "fsync.h"
 
 #include "pshpack4.h"
@@ -459,6 +461,93 @@ DECL_HANDLER(open_fsync)
     }
 }
 
+/* return the handle map entry describing an object, or 0 if the client has to ask */
+static unsigned int get_handle_map_entry( struct object *obj, unsigned int access )
+{
+    enum fsync_type type;
+    unsigned int shm_idx;
+
+    if (!(access & SYNCHRONIZE) || !obj->ops->get_fsync_idx) return 0;
+    /* fd objects need to look up their fd, leave them to get_fsync_idx */
+    if (obj->ops->get_fsync_idx == default_fd_get_fsync_idx) return 0;
+    if (!(shm_idx = obj->ops->get_fsync_idx( obj, &type ))) return 0;
+    if (shm_idx >= (1u << (32 - FSYNC_HANDLE_MAP_TYPE_BITS))) return 0;
+    return (shm_idx << FSYNC_HANDLE_MAP_TYPE_BITS) | type;
+}
+
+static inline unsigned int handle_map_index( obj_handle_t handle )
+{
+    return (handle >> 2) - 1;
+}
+
+/* publish the fsync object of a newly allocated handle */
+void fsync_set_handle( struct process *process, obj_handle_t handle,
+                       struct object *obj, unsigned int access )
+{
+    unsigned int idx = handle_map_index( handle );
+
+    if (!process->fsync_handle_map || idx >= FSYNC_HANDLE_MAP_ENTRIES) return;
+    __atomic_store_n( &process->fsync_handle_map[idx], get_handle_map_entry( obj, access ),
+                      __ATOMIC_SEQ_CST );
+}
+
+/* remove a closed handle from the handle map */
+void fsync_clear_handle( struct process *process, obj_handle_t handle )
+{
+    unsigned int idx = handle_map_index( handle );
+
+    if (!process->fsync_handle_map || idx >= FSYNC_HANDLE_MAP_ENTRIES) return;
+    __atomic_store_n( &process->fsync_handle_map[idx], 0, __ATOMIC_SEQ_CST );
+}
+
+void fsync_free_handle_map( struct process *process )
+{
+    if (!process->fsync_handle_map) return;
+    munmap( process->fsync_handle_map, FSYNC_HANDLE_MAP_ENTRIES * sizeof(unsigned int) );
+    process->fsync_handle_map = NULL;
+}
+
+/* create the handle map of a process; the pages are only populated once written to */
+static int create_handle_map( struct process *process )
+{
+#if defined(__linux__) && defined(__NR_memfd_create)
+    size_t size = FSYNC_HANDLE_MAP_ENTRIES * sizeof(unsigned int);
+    void *ptr;
+    int fd;
+
+    if ((fd = syscall( __NR_memfd_create, "wineserver_fsync_handles", 0 )) == -1) return -1;
+    if (ftruncate( fd, size ) == -1 ||
+        (ptr = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 )) == MAP_FAILED)
+    {
+        close( fd );
+        return -1;
+    }
+    process->fsync_handle_map = ptr;
+    publish_fsync_handles( process );
+    return fd;
+#else
+    return -1;
+#endif
+}
+
+DECL_HANDLER(get_fsync_handle_map)
+{
+    int fd;
+
+    if (!do_fsync() || current->process->fsync_handle_map)
+    {
+        set_error( STATUS_NOT_SUPPORTED );
+        return;
+    }
+    if ((fd = create_handle_map( current->process )) == -1)
+    {
+        set_error( STATUS_NO_MEMORY );
+        return;
+    }
+    send_client_fd( current->process, fd, 0 );
+    close( fd );
+}
+
 /* Retrieve the index of a shm section which will be signaled by the server. */
 DECL_HANDLER(get_fsync_idx)
 {
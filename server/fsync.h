@@ -25,6 +25,12 @@ extern void fsync_wake_futex( unsigned int shm_idx );
 extern void fsync_clear_futex( unsigned int shm_idx );
 extern void fsync_wake_up( struct object *obj );
 extern void fsync_clear( struct object *obj );
+struct process;
+
+extern void fsync_set_handle( struct process *process, obj_handle_t handle,
+                              struct object *obj, unsigned int access );
+extern void fsync_clear_handle( struct process *process, obj_handle_t handle );
+extern void fsync_free_handle_map( struct process *process );
 
 struct fsync;
 
@@ -38,11 +38,12 @@
 #include "thread.h"
 #include "security.h"
 #include "request.h"
+#include "fsync.h"
 
 struct handle_entry
 {
     struct object *ptr;       /* object */
-    unsigned int   access;    /* access rights */
+    unsigned int   access;    /* access rights, or index of the next free entry if ptr is NULL */
 };
 
 struct handle_table
@@ -51,7 +52,8 @@ struct handle_table
     struct process      *process;     /* process owning this table */
     int                  count;       /* number of allocated entries */
     int                  last;        /* last used entry */
-    int                  free;        /* first entry that may be free */
+    int                  top;         /* number of entries handed out so far; free ones below it are in the free list */
+    int                  free;        /* head of the free list, or -1 if empty */
     struct handle_entry *entries;     /* handle entries */
 };
 
@@ -212,7 +214,8 @@ struct handle_table *alloc_handle_table( struct process *process, int count )
     table->process = process;
     table->count   = count;
     table->last    = -1;
-    table->free    = 0;
+    table->top     = 0;
+    table->free    = -1;
     if ((table->entries = mem_alloc( count * sizeof(*table->entries) ))) return table;
     release_object( table );
     return NULL;
@@ -235,26 +238,51 @@ static int grow_handle_table( struct handle_table *table )
     return 1;
 }
 
-/* allocate the first free entry in the handle table */
+/* add an unused entry to the head of the free list */
+static inline void push_free_entry( struct handle_table *table, int index )
+{
+    table->entries[index].access = table->free;
+    table->free = index;
+}
+
+/* rebuild the free list from the unused entries up to the last used one */
+static void rebuild_free_list( struct handle_table *table )
+{
+    int i;
+
+    table->top  = table->last + 1;
+    table->free = -1;
+    for (i = table->last; i >= 0; i--)
+        if (!table->entries[i].ptr) push_free_entry( table, i );
+}
+
+/* allocate a free entry in the handle table, reusing the most recently freed one */
 static obj_handle_t alloc_entry( struct handle_table *table, struct object *obj, unsigned int access )
 {
-    struct handle_entry *entry = table->entries + table->free;
+    struct handle_entry *entry;
     int i;
 
-    for (i = table->free; i <= table->last; i++, entry++) if (!entry->ptr) goto found;
-    if (i >= table->count)
+    if (table->free != -1)
+    {
+        i = table->free;
+        entry = table->entries + i;
+        table->free = entry->access;
+    }
+    else
     {
-        if (!grow_handle_table( table )) return 0;
-        entry = table->entries + i;  /* the entries may have moved */
+        if (table->top >= table->count && !grow_handle_table( table )) return 0;
+        i = table->top++;
+        entry = table->entries + i;
     }
-    table->last = i;
- found:
-    table->free = i + 1;
+    if (i > table->last) table->last = i;
     entry->ptr    = grab_object_for_handle( obj );
     entry->access = access;
 
     if (table->process)
+    {
         obj->ops->alloc_handle( obj, table->process, index_to_handle(i) );
+        fsync_set_handle( table->process, index_to_handle(i), obj, access );
+    }
 
     return index_to_handle(i);
 }
@@ -358,6 +386,8 @@ static void shrink_handle_table( struct handle_table *table )
     if (!(new_entries = realloc( table->entries, count * sizeof(*new_entries) ))) return;
     table->count   = count;
     table->entries = new_entries;
+    /* drop the entries past the end from the free list */
+    rebuild_free_list( table );
 }
 
 /* copy the handle table of the parent process */
@@ -389,6 +419,7 @@ struct handle_table *copy_handle_table( struct process *process, struct process
             else ptr->ptr = NULL; /* don't inherit this entry */
         }
     }
+    rebuild_free_list( table );
     /* attempt to shrink the table */
     shrink_handle_table( table );
     return table;
@@ -406,8 +437,9 @@ unsigned int close_handle( struct process *process, obj_handle_t handle )
     obj = entry->ptr;
     if (!obj->ops->close_handle( obj, process, handle )) return STATUS_HANDLE_NOT_CLOSABLE;
     entry->ptr = NULL;
+    if (!handle_is_global(handle)) fsync_clear_handle( process, handle );
     table = handle_is_global(handle) ? global_table : process->handles;
-    if (entry < table->entries + table->free) table->free = entry - table->entries;
+    push_free_entry( table, entry - table->entries );
     if (entry == table->entries + table->last) shrink_handle_table( table );
     release_object_from_handle( obj );
     return STATUS_SUCCESS;
@@ -519,6 +551,18 @@ obj_handle_t enumerate_handles( struct process *process, const struct object_ops
     return 0;
 }
 
+/* fill the fsync handle map of a process with its current handles */
+void publish_fsync_handles( struct process *process )
+{
+    struct handle_table *table = process->handles;
+    struct handle_entry *entry;
+    int i;
+
+    if (!table) return;
+    for (i = 0, entry = table->entries; i <= table->last; i++, entry++)
+        if (entry->ptr) fsync_set_handle( process, index_to_handle(i), entry->ptr, entry->access );
+}
+
 /* get/set the handle reserved flags */
 /* return the old flags (or -1 on error) */
 static int set_handle_flags( struct process *process, obj_handle_t handle, int mask, int flags )
@@ -54,5 +54,6 @@ extern void close_process_handles( struct process *process );
 extern struct handle_table *alloc_handle_table( struct process *process, int count );
 extern struct handle_table *copy_handle_table( struct process *process, struct process *parent );
 extern unsigned int get_handle_table_count( struct process *process);
+extern void publish_fsync_handles( struct process *process );
 
 #endif  /* __WINE_SERVER_HANDLE_H */
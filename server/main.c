@@ -150,6 +150,7 @@ int main( int argc, char *argv[] )
         esync_init();
 
     if (debug_level) fprintf( stderr, "wineserver: starting (pid=%ld)\n", (long) getpid() );
+    init_request_stats();
     init_scheduler();
     init_signals();
     init_directories();
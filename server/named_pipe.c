@@ -64,6 +64,7 @@ struct pipe_end
     process_id_t         server_pid; /* process that created the server */
     data_size_t          buffer_size;/* size of buffered data that doesn't block caller */
     struct list          message_queue;
+    unsigned int         write_count;/* number of queued messages with a pending write async */
     struct async_queue   read_q;     /* read queue */
     struct async_queue   write_q;    /* write queue */
 };
@@ -378,12 +379,13 @@ static struct pipe_message *queue_message( struct pipe_end *pipe_end, struct ios
     return message;
 }
 
-static void wake_message( struct pipe_message *message, data_size_t result )
+static void wake_message( struct pipe_end *pipe_end, struct pipe_message *message, data_size_t result )
 {
     struct async *async = message->async;
 
     message->async = NULL;
     if (!async) return;
+    pipe_end->write_count--;
 
     message->iosb->status = STATUS_SUCCESS;
     message->iosb->result = result;
@@ -415,6 +417,7 @@ static void pipe_end_disconnect( struct pipe_end *pipe_end, unsigned int status
         async = message->async;
         if (async || status == STATUS_PIPE_DISCONNECTED) free_message( message );
         if (!async) continue;
+        pipe_end->write_count--;
         async_terminate( async, status );
         release_object( async );
     }
@@ -511,7 +514,7 @@ static void named_pipe_device_destroy( struct object *obj )
 {
     struct named_pipe_device *device = (struct named_pipe_device*)obj;
     assert( obj->ops == &named_pipe_device_ops );
-    free( device->pipes );
+    free_namespace( device->pipes );
 }
 
 struct object *create_named_pipe_device( struct object *root, const struct unicode_str *name )
@@ -763,7 +766,7 @@ static void message_queue_read( struct pipe_end *pipe_end, struct iosb *iosb )
     {
         iosb->out_data = message->iosb->in_data;
         message->iosb->in_data = NULL;
-        wake_message( message, message->iosb->in_size );
+        wake_message( pipe_end, message, message->iosb->in_size );
         free_message( message );
     }
     else
@@ -787,8 +790,8 @@ static void message_queue_read( struct pipe_end *pipe_end, struct iosb *iosb )
             message->read_pos += writing;
             if (message->read_pos == message->iosb->in_size)
             {
-                wake_message(message, message->iosb->in_size);
-                free_message(message);
+                wake_message( pipe_end, message, message->iosb->in_size );
+                free_message( message );
             }
         } while (write_pos < iosb->out_size);
     }
@@ -835,6 +838,14 @@ static void reselect_write_queue( struct pipe_end *pipe_end )
 
     if (!reader) return;
 
+    /* nothing to do if none of the queued messages is still being written,
+     * which saves walking the whole queue after every read in the common case */
+    if (!reader->write_count)
+    {
+        reselect_read_queue( reader, 0 );
+        return;
+    }
+
     ignore_reselect = 1;
 
     LIST_FOR_EACH_ENTRY_SAFE( message, next, &reader->message_queue, struct pipe_message, entry )
@@ -843,6 +854,7 @@ static void reselect_write_queue( struct pipe_end *pipe_end )
         {
             release_object( message->async );
             message->async = NULL;
+            reader->write_count--;
             free_message( message );
         }
         else
@@ -850,11 +862,11 @@ static void reselect_write_queue( struct pipe_end *pipe_end )
             avail += message->iosb->in_size - message->read_pos;
             if (message->async && (avail <= reader->buffer_size || !message->iosb->in_size))
             {
-                wake_message( message, message->iosb->in_size );
+                wake_message( reader, message, message->iosb->in_size );
             }
             else if (message->async && (pipe_end->flags & NAMED_PIPE_NONBLOCKING_MODE))
             {
-                wake_message( message, message->read_pos );
+                wake_message( reader, message, message->read_pos );
                 free_message( message );
             }
         }
@@ -924,6 +936,7 @@ static int pipe_end_write( struct fd *fd, struct async *async, file_pos_t pos )
     if (!message) return 0;
 
     message->async = (struct async *)grab_object( async );
+    pipe_end->connection->write_count++;
     queue_async( &pipe_end->write_q, async );
     reselect_read_queue( pipe_end->connection, 1 );
     set_error( STATUS_PENDING );
@@ -1180,6 +1193,7 @@ static void init_pipe_end( struct pipe_end *pipe_end, struct named_pipe *pipe,
     pipe_end->flags = pipe_flags;
     pipe_end->connection = NULL;
     pipe_end->buffer_size = buffer_size;
+    pipe_end->write_count = 0;
     init_async_queue( &pipe_end->read_q );
     init_async_queue( &pipe_end->write_q );
     list_init( &pipe_end->message_queue );
@@ -46,9 +46,13 @@
 struct namespace
 {
     unsigned int        hash_size;       /* size of hash table */
-    struct list         names[1];        /* array of hash entry lists */
+    unsigned int        count;           /* number of names in the table */
+    struct list        *names;           /* array of hash entry lists */
 };
 
+/* the hash table is grown when it holds more names than this per bucket on average */
+#define NAMESPACE_MAX_LOAD 2
+
 
 #ifdef DEBUG_OBJECTS
 static struct list object_list = LIST_INIT(object_list);
@@ -127,19 +131,44 @@ void *memdup( const void *data, size_t len )
 
 /*****************************************************************/
 
-static int get_name_hash( const struct namespace *namespace, const WCHAR *name, data_size_t len )
+static unsigned int get_name_hash( const WCHAR *name, data_size_t len )
 {
-    WCHAR hash = 0;
+    unsigned int hash = 0;
     len /= sizeof(WCHAR);
-    while (len--) hash ^= tolowerW(*name++);
-    return hash % namespace->hash_size;
+    while (len--) hash = hash * 31 + tolowerW(*name++);
+    return hash;
+}
+
+/* grow the hash table of a namespace, keeping the existing names */
+static void grow_namespace( struct namespace *namespace )
+{
+    unsigned int i, hash_size = namespace->hash_size * 2 + 1;
+    struct object_name *ptr, *next;
+    struct list *names;
+
+    if (!(names = malloc( hash_size * sizeof(*names) ))) return;  /* keep using the old table */
+    for (i = 0; i < hash_size; i++) list_init( &names[i] );
+    for (i = 0; i < namespace->hash_size; i++)
+    {
+        LIST_FOR_EACH_ENTRY_SAFE( ptr, next, &namespace->names[i], struct object_name, entry )
+        {
+            list_remove( &ptr->entry );
+            list_add_tail( &names[ptr->hash % hash_size], &ptr->entry );
+        }
+    }
+    free( namespace->names );
+    namespace->names = names;
+    namespace->hash_size = hash_size;
 }
 
 void namespace_add( struct namespace *namespace, struct object_name *ptr )
 {
-    int hash = get_name_hash( namespace, ptr->name, ptr->len );
+    if (namespace->count >= namespace->hash_size * NAMESPACE_MAX_LOAD) grow_namespace( namespace );
 
-    list_add_head( &namespace->names[hash], &ptr->entry );
+    ptr->namespace = namespace;
+    ptr->hash = get_name_hash( ptr->name, ptr->len );
+    list_add_head( &namespace->names[ptr->hash % namespace->hash_size], &ptr->entry );
+    namespace->count++;
 }
 
 /* allocate a name for an object */
@@ -150,6 +179,7 @@ static struct object_name *alloc_name( const struct unicode_str *name )
     if ((ptr = mem_alloc( sizeof(*ptr) + name->len - sizeof(ptr->name) )))
     {
         ptr->len = name->len;
+        ptr->namespace = NULL;
         ptr->parent = NULL;
         memcpy( ptr->name, name->str, name->len );
     }
@@ -438,14 +468,16 @@ struct object *find_object( const struct namespace *namespace, const struct unic
 {
     const struct list *list;
     struct list *p;
+    unsigned int hash;
 
     if (!name || !name->len) return NULL;
 
-    list = &namespace->names[ get_name_hash( namespace, name->str, name->len ) ];
+    hash = get_name_hash( name->str, name->len );
+    list = &namespace->names[hash % namespace->hash_size];
     LIST_FOR_EACH( p, list )
     {
         const struct object_name *ptr = LIST_ENTRY( p, struct object_name, entry );
-        if (ptr->len != name->len) continue;
+        if (ptr->hash != hash || ptr->len != name->len) continue;
         if (attributes & OBJ_CASE_INSENSITIVE)
         {
             if (!strncmpiW( ptr->name, name->str, name->len/sizeof(WCHAR) ))
@@ -484,15 +516,43 @@ struct namespace *create_namespace( unsigned int hash_size )
     struct namespace *namespace;
     unsigned int i;
 
-    namespace = mem_alloc( sizeof(*namespace) + (hash_size - 1) * sizeof(namespace->names[0]) );
-    if (namespace)
+    if (!(namespace = mem_alloc( sizeof(*namespace) ))) return NULL;
+    if (!(namespace->names = mem_alloc( hash_size * sizeof(namespace->names[0]) )))
     {
-        namespace->hash_size      = hash_size;
-        for (i = 0; i < hash_size; i++) list_init( &namespace->names[i] );
+        free( namespace );
+        return NULL;
     }
+    namespace->hash_size      = hash_size;
+    namespace->count          = 0;
+    for (i = 0; i < hash_size; i++) list_init( &namespace->names[i] );
     return namespace;
 }
 
+/* free a namespace */
+void free_namespace( struct namespace *namespace )
+{
+    if (!namespace) return;
+    free( namespace->names );
+    free( namespace );
+}
+
+/* dump the hash table statistics of a namespace */
+void dump_namespace( const struct namespace *namespace )
+{
+    unsigned int i, len, used = 0, longest = 0;
+    struct list *p;
+
+    for (i = 0; i < namespace->hash_size; i++)
+    {
+        len = 0;
+        LIST_FOR_EACH( p, &namespace->names[i] ) len++;
+        if (len) used++;
+        if (len > longest) longest = len;
+    }
+    fprintf( stderr, "names=%u buckets=%u used=%u longest=%u", namespace->count,
+             namespace->hash_size, used, longest );
+}
+
 /* functions for unimplemented/default object operations */
 
 struct object_type *no_get_type( struct object *obj )
@@ -699,6 +759,7 @@ int no_link_name( struct object *obj, struct object_name *name, struct object *p
 void default_unlink_name( struct object *obj, struct object_name *name )
 {
     list_remove( &name->entry );
+    if (name->namespace) name->namespace->count--;
 }
 
 struct object *no_open_file( struct object *obj, unsigned int access, unsigned int sharing,
@@ -119,6 +119,8 @@ struct object
 struct object_name
 {
     struct list         entry;           /* entry in the hash list */
+    struct namespace   *namespace;       /* namespace containing the name, if any */
+    unsigned int        hash;            /* case-folded hash of the name */
     struct object      *obj;             /* object owning this name */
     struct object      *parent;          /* parent object */
     data_size_t         len;             /* name length in bytes */
@@ -149,6 +151,8 @@ extern void *open_named_object( struct object *parent, const struct object_ops *
 extern void unlink_named_object( struct object *obj );
 extern void make_object_static( struct object *obj );
 extern struct namespace *create_namespace( unsigned int hash_size );
+extern void free_namespace( struct namespace *namespace );
+extern void dump_namespace( const struct namespace *namespace );
 extern void free_kernel_objects( struct object *obj );
 /* grab/release_object can take any pointer, but you better make sure */
 /* that the thing pointed to starts with a struct object... */
@@ -544,6 +544,7 @@ struct process *create_process( int fd, struct process *parent, int inherit_all,
     list_init( &process->kernel_object );
     process->esync_fd        = -1;
     process->fsync_idx       = 0;
+    process->fsync_handle_map = NULL;
     list_init( &process->thread_list );
     list_init( &process->locks );
     list_init( &process->asyncs );
@@ -644,6 +645,7 @@ static void process_destroy( struct object *obj )
 
     if (do_esync())
         close( process->esync_fd );
+    fsync_free_handle_map( process );
 }
 
 /* dump a process on stdout for debugging purposes */
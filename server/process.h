@@ -100,6 +100,7 @@ struct process
     struct list          kernel_object;   /* list of kernel object pointers */
     int                  esync_fd;        /* esync file descriptor (signaled on exit) */
     unsigned int         fsync_idx;
+    unsigned int        *fsync_handle_map;/* handle to fsync object map shared with the client */
 };
 
 struct process_snapshot
@@ -78,6 +78,10 @@ struct key
     int               last_subkey; /* last in use subkey */
     int               nb_subkeys;  /* count of allocated subkeys */
     struct key      **subkeys;     /* subkeys array */
+    struct key      **subkey_hash; /* hash table of subkeys, for keys with many subkeys */
+    unsigned int      hash_size;   /* size of the subkey hash table */
+    unsigned int      name_hash;   /* case-insensitive hash of the key name */
+    struct key       *hash_next;   /* next key in the parent's hash table */
     int               last_value;  /* last in use value */
     int               nb_values;   /* count of allocated values in array */
     struct key_value *values;      /* values array */
@@ -105,6 +109,7 @@ struct key_value
 };
 
 #define MIN_SUBKEYS  8   /* min. number of allocated subkeys per key */
+#define MIN_SUBKEY_HASH  64  /* min. number of subkeys to build a subkey hash table */
 #define MIN_VALUES   8   /* min. number of allocated values per key */
 
 #define MAX_NAME_LEN  256    /* max. length of a key name */
@@ -138,6 +143,8 @@ static int save_branch_count;
 static struct save_branch_info save_branch_info[MAX_SAVE_BRANCH_INFO];
 
 
+#define MAX_LOAD_DEPTH 32
+
 /* information about a file being loaded */
 struct file_load_info
 {
@@ -148,6 +155,11 @@ struct file_load_info
     int         line;     /* current input line */
     WCHAR      *tmp;      /* temp buffer to use while parsing input */
     size_t      tmplen;   /* length of temp buffer */
+    WCHAR      *path;     /* name of the last loaded key, relative to the base key */
+    size_t      pathlen;  /* length of path buffer */
+    int         depth;    /* number of path elements with a cached key */
+    data_size_t path_ends[MAX_LOAD_DEPTH];      /* length of the name up to each element */
+    struct key *path_keys[MAX_LOAD_DEPTH];      /* key for each element */
 };
 
 
@@ -445,6 +457,7 @@ static void key_destroy( struct object *obj )
         release_object( key->subkeys[i] );
     }
     free( key->subkeys );
+    free( key->subkey_hash );
     /* unconditionally notify everything waiting on this key */
     while ((ptr = list_head( &key->notify_list )))
     {
@@ -494,6 +507,68 @@ static struct unicode_str *get_path_token( const struct unicode_str *path, struc
     return token;
 }
 
+/* case-insensitive hash of a key name */
+static unsigned int hash_key_name( const struct unicode_str *name )
+{
+    unsigned int i, hash = 0;
+
+    for (i = 0; i < name->len / sizeof(WCHAR); i++) hash = hash * 31 + tolowerW( name->str[i] );
+    return hash;
+}
+
+/* (re)build the subkey hash table of a key */
+static void build_subkey_hash( struct key *key )
+{
+    struct key **hash;
+    unsigned int i, size = key->hash_size ? key->hash_size * 2 : MIN_SUBKEY_HASH * 2;
+
+    while (size < key->last_subkey + 1) size *= 2;
+    if (!(hash = calloc( size, sizeof(*hash) ))) return;  /* keep using the old table, if any */
+
+    free( key->subkey_hash );
+    key->subkey_hash = hash;
+    key->hash_size   = size;
+    for (i = 0; i <= key->last_subkey; i++)
+    {
+        struct key *subkey = key->subkeys[i];
+        struct key **entry = &hash[subkey->name_hash & (size - 1)];
+        subkey->hash_next = *entry;
+        *entry = subkey;
+    }
+}
+
+/* add a new subkey to the hash table of its parent */
+static void add_subkey_hash( struct key *parent, struct key *key )
+{
+    struct key **entry;
+
+    if (!parent->subkey_hash && parent->last_subkey + 1 < MIN_SUBKEY_HASH) return;
+    if (!parent->subkey_hash || parent->last_subkey + 1 > parent->hash_size)
+    {
+        build_subkey_hash( parent );  /* this also adds the new key */
+        return;
+    }
+    entry = &parent->subkey_hash[key->name_hash & (parent->hash_size - 1)];
+    key->hash_next = *entry;
+    *entry = key;
+}
+
+/* remove a subkey from the hash table of its parent */
+static void remove_subkey_hash( struct key *parent, struct key *key )
+{
+    struct key **entry;
+
+    if (!parent->subkey_hash) return;
+    for (entry = &parent->subkey_hash[key->name_hash & (parent->hash_size - 1)]; *entry;
+         entry = &(*entry)->hash_next)
+    {
+        if (*entry != key) continue;
+        *entry = key->hash_next;
+        break;
+    }
+    key->hash_next = NULL;
+}
+
 /* allocate a key object */
 static struct key *alloc_key( const struct unicode_str *name, timeout_t modif )
 {
@@ -508,6 +583,10 @@ static struct key *alloc_key( const struct unicode_str *name, timeout_t modif )
         key->last_subkey = -1;
         key->nb_subkeys  = 0;
         key->subkeys     = NULL;
+        key->subkey_hash = NULL;
+        key->hash_size   = 0;
+        key->name_hash   = hash_key_name( name );
+        key->hash_next   = NULL;
         key->nb_values   = 0;
         key->last_value  = -1;
         key->values      = NULL;
@@ -620,6 +699,7 @@ static struct key *alloc_subkey( struct key *parent, const struct unicode_str *n
         for (i = ++parent->last_subkey; i > index; i--)
             parent->subkeys[i] = parent->subkeys[i-1];
         parent->subkeys[index] = key;
+        add_subkey_hash( parent, key );
         if (is_wow6432node( key->name, key->namelen ) && !is_wow6432node( parent->name, parent->namelen ))
             parent->flags |= KEY_WOW64;
     }
@@ -636,6 +716,7 @@ static void free_subkey( struct key *parent, int index )
     assert( index <= parent->last_subkey );
 
     key = parent->subkeys[index];
+    remove_subkey_hash( parent, key );
     for (i = index; i < parent->last_subkey; i++) parent->subkeys[i] = parent->subkeys[i + 1];
     parent->last_subkey--;
     key->flags |= KEY_DELETED;
@@ -656,12 +737,27 @@ static void free_subkey( struct key *parent, int index )
     }
 }
 
-/* find the named child of a given key and return its index */
+/* find the named child of a given key */
+/* if not found, index is set to the position where it should be inserted */
 static struct key *find_subkey( const struct key *key, const struct unicode_str *name, int *index )
 {
     int i, min, max, res;
     data_size_t len;
 
+    if (key->subkey_hash)
+    {
+        unsigned int hash = hash_key_name( name );
+        struct key *subkey;
+
+        for (subkey = key->subkey_hash[hash & (key->hash_size - 1)]; subkey; subkey = subkey->hash_next)
+        {
+            if (subkey->name_hash != hash || subkey->namelen != name->len) continue;
+            if (memicmpW( subkey->name, name->str, name->len / sizeof(WCHAR) )) continue;
+            *index = -1;  /* not needed by callers when the key exists */
+            return subkey;
+        }
+    }
+
     min = 0;
     max = key->last_subkey;
     while (min <= max)
@@ -1376,6 +1472,85 @@ static int get_data_type( const char *buffer, int *type, int *parse_type )
     return 0;
 }
 
+/* release the cached keys of the last loaded path beyond a given depth */
+static void truncate_load_path( struct file_load_info *info, int depth )
+{
+    while (info->depth > depth) release_object( info->path_keys[--info->depth] );
+}
+
+/* create a key from the input file, reusing the parents of the last loaded key */
+/* keys are saved depth-first, so consecutive keys almost always share most of their path */
+static struct key *create_load_key( struct key *base, const struct unicode_str *name,
+                                    struct file_load_info *info )
+{
+    struct unicode_str token, rest;
+    struct key *key = base;
+    WCHAR *path;
+    int i, index, new_depth = -1;  /* depth of the first key created for this path */
+
+    for (i = 0; i < info->depth; i++)
+    {
+        data_size_t end = info->path_ends[i];
+
+        if (end > name->len || memcmp( info->path, name->str, end )) break;
+        if (end < name->len && name->str[end / sizeof(WCHAR)] != '\\') break;
+        /* a key may have become a link since it was cached */
+        if (info->path_keys[i]->flags & KEY_SYMLINK) break;
+    }
+    truncate_load_path( info, i );
+
+    if (info->pathlen < name->len)
+    {
+        if (!(path = realloc( info->path, name->len )))
+        {
+            truncate_load_path( info, 0 );
+            set_error( STATUS_NO_MEMORY );
+            return NULL;
+        }
+        info->path = path;
+        info->pathlen = name->len;
+    }
+    memcpy( info->path, name->str, name->len );
+
+    token.str = NULL;
+    token.len = 0;
+    if (info->depth)
+    {
+        key = info->path_keys[info->depth - 1];
+        token.str = name->str + info->path_ends[info->depth - 1] / sizeof(WCHAR);
+    }
+    if (!get_path_token( name, &token )) return NULL;
+
+    while (token.len)
+    {
+        if (info->depth == MAX_LOAD_DEPTH)
+        {
+            /* too deep to cache, create the rest in one go */
+            rest.str = token.str;
+            rest.len = name->len - (token.str - name->str) * sizeof(WCHAR);
+            if ((key = create_key_recursive( key, &rest, 0 ))) return key;
+            goto failed;
+        }
+        if (new_depth == -1 && !find_subkey( key, &token, &index )) new_depth = info->depth;
+        if (!(key = create_key_recursive( key, &token, 0 ))) goto failed;
+        info->path_ends[info->depth] = (token.str - name->str) * sizeof(WCHAR) + token.len;
+        info->path_keys[info->depth++] = key;
+        get_path_token( name, &token );
+    }
+    return (struct key *)grab_object( key );
+
+failed:
+    /* remove the keys already created for this path */
+    if (new_depth != -1 && new_depth < info->depth)
+    {
+        key = (struct key *)grab_object( info->path_keys[new_depth] );
+        truncate_load_path( info, new_depth );
+        delete_key( key, 1 );
+        release_object( key );
+    }
+    return NULL;
+}
+
 /* load and create a key from the input file */
 static struct key *load_key( struct key *base, const char *buffer, int prefix_len,
                              struct file_load_info *info, timeout_t *modif )
@@ -1415,7 +1590,7 @@ static struct key *load_key( struct key *base, const char *buffer, int prefix_le
     }
     name.str = p;
     name.len = len - (p - info->tmp + 1) * sizeof(WCHAR);
-    return create_key_recursive( base, &name, 0 );
+    return create_load_key( base, &name, info );
 }
 
 /* update the modification time of a key (and its parents) after it has been loaded from a file */
@@ -1491,20 +1666,39 @@ static int load_key_option( struct key *key, const char *buffer, struct file_loa
     return 1;
 }
 
+/* return the value of a hex digit, or -1 */
+static inline int hex_digit_value( char c )
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
 /* parse a comma-separated list of hex digits */
 static int parse_hex( unsigned char *dest, data_size_t *len, const char *buffer )
 {
     const char *p = buffer;
     data_size_t count = 0;
-    char *end;
+    int digit;
 
-    while (isxdigit(*p))
+    while ((digit = hex_digit_value( *p )) != -1)
     {
-        unsigned int val = strtoul( p, &end, 16 );
-        if (end == p || val > 0xff) return -1;
+        unsigned int val = 0;
+
+        /* accept a 0x prefix, like strtoul did */
+        if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X') && hex_digit_value( p[2] ) != -1)
+        {
+            p += 2;
+            digit = hex_digit_value( *p );
+        }
+        do
+        {
+            val = (val << 4) | digit;
+            if (val > 0xff) return -1;
+        } while ((digit = hex_digit_value( *++p )) != -1);
         if (count++ >= *len) return -1;  /* dest buffer overflow */
         *dest++ = val;
-        p = end;
         while (isspace(*p)) p++;
         if (*p == ',') p++;
         while (isspace(*p)) p++;
@@ -1657,6 +1851,9 @@ static void load_keys( struct key *key, const char *filename, FILE *f, int prefi
     info.len    = 4;
     info.tmplen = 4;
     info.line   = 0;
+    info.path   = NULL;
+    info.pathlen = 0;
+    info.depth  = 0;
     if (!(info.buffer = mem_alloc( info.len ))) return;
     if (!(info.tmp = mem_alloc( info.tmplen )))
     {
@@ -1711,8 +1908,10 @@ static void load_keys( struct key *key, const char *filename, FILE *f, int prefi
         update_key_time( subkey, modif );
         release_object( subkey );
     }
+    truncate_load_path( &info, 0 );
     free( info.buffer );
     free( info.tmp );
+    free( info.path );
 }
 
 /* load a part of the registry from a file */
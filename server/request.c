@@ -296,11 +296,74 @@ static void send_reply( union generic_reply *reply )
         fatal_protocol_error( current, "reply write: %s\n", strerror( errno ));
 }
 
+/* per-request statistics, only collected when WINESERVER_PROFILE is set */
+struct request_stats
+{
+    unsigned int     count;   /* number of calls */
+    unsigned __int64 total;   /* total time spent in the handler, in ns */
+    unsigned __int64 max;     /* longest call, in ns */
+};
+
+static struct request_stats *request_stats;
+static unsigned __int64 profile_start;
+
+/* return a monotonic time in nanoseconds for request profiling */
+static unsigned __int64 get_profile_time(void)
+{
+#ifdef HAVE_CLOCK_GETTIME
+    struct timespec ts;
+
+    if (!clock_gettime( CLOCK_MONOTONIC, &ts )) return ts.tv_sec * (unsigned __int64)1000000000 + ts.tv_nsec;
+#endif
+    return (current_time - server_start_time) * 100;
+}
+
+/* dump the request statistics to stderr */
+void dump_request_stats(void)
+{
+    unsigned __int64 elapsed, busy = 0, total = 0;
+    unsigned int i;
+
+    if (!request_stats) return;
+
+    elapsed = get_profile_time() - profile_start;
+    fprintf( stderr, "wineserver: request profile (pid=%ld)\n", (long)getpid() );
+    fprintf( stderr, "  %-32s %10s %12s %10s %10s\n", "request", "count", "total(us)", "avg(ns)", "max(us)" );
+    for (i = 0; i < REQ_NB_REQUESTS; i++)
+    {
+        const struct request_stats *stats = &request_stats[i];
+
+        if (!stats->count) continue;
+        total += stats->count;
+        busy += stats->total;
+        fprintf( stderr, "  %-32s %10u %12lu %10lu %10lu\n", get_request_name( i ), stats->count,
+                 (unsigned long)(stats->total / 1000), (unsigned long)(stats->total / stats->count),
+                 (unsigned long)(stats->max / 1000) );
+    }
+    if (!elapsed) elapsed = 1;
+    fprintf( stderr, "  %lu requests in %lu ms, %lu requests/s, handlers busy %u.%u%%\n",
+             (unsigned long)total, (unsigned long)(elapsed / 1000000),
+             (unsigned long)(total * 1000000000 / elapsed),
+             (unsigned int)(busy * 100 / elapsed), (unsigned int)(busy * 1000 / elapsed % 10) );
+}
+
+/* enable request profiling if requested in the environment */
+void init_request_stats(void)
+{
+    const char *env = getenv( "WINESERVER_PROFILE" );
+
+    if (!env || !atoi( env )) return;
+    if (!(request_stats = calloc( REQ_NB_REQUESTS, sizeof(*request_stats) ))) return;
+    profile_start = get_profile_time();
+    atexit( dump_request_stats );
+}
+
 /* call a request handler */
 static void call_req_handler( struct thread *thread )
 {
     union generic_reply reply;
     enum request req = thread->req.request_header.req;
+    unsigned __int64 start = 0;
 
     current = thread;
     current->reply_size = 0;
@@ -310,7 +373,17 @@ static void call_req_handler( struct thread *thread )
     if (debug_level) trace_request();
 
     if (req < REQ_NB_REQUESTS)
+    {
+        if (request_stats) start = get_profile_time();
         req_handlers[req]( &current->req, &reply );
+        if (request_stats)
+        {
+            unsigned __int64 time = get_profile_time() - start;
+            request_stats[req].count++;
+            request_stats[req].total += time;
+            if (time > request_stats[req].max) request_stats[req].max = time;
+        }
+    }
     else
         set_error( STATUS_NOT_IMPLEMENTED );
 
@@ -332,6 +405,13 @@ static void call_req_handler( struct thread *thread )
     current = NULL;
 }
 
+/* release the request data once the request has been handled */
+void free_req_data( struct thread *thread )
+{
+    if (thread->req_data != thread->req_inline.data) free( thread->req_data );
+    thread->req_data = NULL;
+}
+
 /* read a request from a thread */
 void read_request( struct thread *thread )
 {
@@ -339,20 +419,39 @@ void read_request( struct thread *thread )
 
     if (!thread->req_toread)  /* no pending request */
     {
-        if ((ret = read( get_unix_fd( thread->request_fd ), &thread->req,
-                         sizeof(thread->req) )) != sizeof(thread->req)) goto error;
+        struct iovec vec[2];
+
+        /* read the header and as much data as fits inline in a single call */
+        vec[0].iov_base = &thread->req;
+        vec[0].iov_len  = sizeof(thread->req);
+        vec[1].iov_base = thread->req_inline.data;
+        vec[1].iov_len  = sizeof(thread->req_inline.data);
+
+        if ((ret = readv( get_unix_fd( thread->request_fd ), vec, 2 )) < (int)sizeof(thread->req)) goto error;
+        ret -= sizeof(thread->req);
+        if ((unsigned int)ret > thread->req.request_header.request_size) goto error;
         if (!(thread->req_toread = thread->req.request_header.request_size))
         {
             /* no data, handle request at once */
             call_req_handler( thread );
             return;
         }
-        if (!(thread->req_data = malloc( thread->req_toread )))
+        if (thread->req_toread <= sizeof(thread->req_inline.data))
+            thread->req_data = thread->req_inline.data;
+        else if ((thread->req_data = malloc( thread->req_toread )))
+            memcpy( thread->req_data, thread->req_inline.data, ret );
+        else
         {
             fatal_protocol_error( thread, "no memory for %u bytes request %d\n",
                                   thread->req_toread, thread->req.request_header.req );
             return;
         }
+        if (!(thread->req_toread -= ret))
+        {
+            call_req_handler( thread );
+            free_req_data( thread );
+            return;
+        }
     }
 
     /* read the variable sized data */
@@ -366,8 +465,7 @@ void read_request( struct thread *thread )
         if (!(thread->req_toread -= ret))
         {
             call_req_handler( thread );
-            free( thread->req_data );
-            thread->req_data = NULL;
+            free_req_data( thread );
             return;
         }
     }
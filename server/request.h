@@ -52,6 +52,7 @@ extern const struct object_attributes *get_req_object_attributes( const struct s
 extern const void *get_req_data_after_objattr( const struct object_attributes *attr, data_size_t *len );
 extern int receive_fd( struct process *process );
 extern int send_client_fd( struct process *process, int fd, obj_handle_t handle );
+extern void free_req_data( struct thread *thread );
 extern void read_request( struct thread *thread );
 extern void write_reply( struct thread *thread );
 extern unsigned int get_tick_count(void);
@@ -65,6 +66,9 @@ extern int server_dir_fd, config_dir_fd;
 
 extern void trace_request(void);
 extern void trace_reply( enum request req, const union generic_reply *reply );
+extern const char *get_request_name( enum request req );
+extern void init_request_stats(void);
+extern void dump_request_stats(void);
 
 /* get the request vararg data */
 static inline const void *get_req_data(void)
@@ -398,6 +402,7 @@ DECL_HANDLER(create_completion);
 DECL_HANDLER(open_completion);
 DECL_HANDLER(add_completion);
 DECL_HANDLER(remove_completion);
+DECL_HANDLER(remove_completions);
 DECL_HANDLER(query_completion);
 DECL_HANDLER(set_completion_info);
 DECL_HANDLER(add_fd_completion);
@@ -415,6 +420,7 @@ DECL_HANDLER(open_fsync);
 DECL_HANDLER(get_fsync_idx);
 DECL_HANDLER(fsync_msgwait);
 DECL_HANDLER(get_fsync_apc_idx);
+DECL_HANDLER(get_fsync_handle_map);
 DECL_HANDLER(update_rawinput_devices);
 DECL_HANDLER(get_rawinput_devices);
 DECL_HANDLER(get_suspend_context);
@@ -725,6 +731,7 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_open_completion,
     (req_handler)req_add_completion,
     (req_handler)req_remove_completion,
+    (req_handler)req_remove_completions,
     (req_handler)req_query_completion,
     (req_handler)req_set_completion_info,
     (req_handler)req_add_fd_completion,
@@ -742,6 +749,7 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_get_fsync_idx,
     (req_handler)req_fsync_msgwait,
     (req_handler)req_get_fsync_apc_idx,
+    (req_handler)req_get_fsync_handle_map,
     (req_handler)req_update_rawinput_devices,
     (req_handler)req_get_rawinput_devices,
     (req_handler)req_get_suspend_context,
@@ -1174,6 +1182,8 @@ C_ASSERT( FIELD_OFFSET(struct enable_socket_event_request, mask) == 16 );
 C_ASSERT( FIELD_OFFSET(struct enable_socket_event_request, sstate) == 20 );
 C_ASSERT( FIELD_OFFSET(struct enable_socket_event_request, cstate) == 24 );
 C_ASSERT( sizeof(struct enable_socket_event_request) == 32 );
+C_ASSERT( FIELD_OFFSET(struct enable_socket_event_reply, state) == 8 );
+C_ASSERT( sizeof(struct enable_socket_event_reply) == 16 );
 C_ASSERT( FIELD_OFFSET(struct set_socket_deferred_request, handle) == 12 );
 C_ASSERT( FIELD_OFFSET(struct set_socket_deferred_request, deferred) == 16 );
 C_ASSERT( sizeof(struct set_socket_deferred_request) == 24 );
@@ -2447,6 +2457,9 @@ C_ASSERT( FIELD_OFFSET(struct remove_completion_reply, cvalue) == 16 );
 C_ASSERT( FIELD_OFFSET(struct remove_completion_reply, information) == 24 );
 C_ASSERT( FIELD_OFFSET(struct remove_completion_reply, status) == 32 );
 C_ASSERT( sizeof(struct remove_completion_reply) == 40 );
+C_ASSERT( FIELD_OFFSET(struct remove_completions_request, handle) == 12 );
+C_ASSERT( sizeof(struct remove_completions_request) == 16 );
+C_ASSERT( sizeof(struct remove_completions_reply) == 8 );
 C_ASSERT( FIELD_OFFSET(struct query_completion_request, handle) == 12 );
 C_ASSERT( sizeof(struct query_completion_request) == 16 );
 C_ASSERT( FIELD_OFFSET(struct query_completion_reply, depth) == 8 );
@@ -2535,6 +2548,7 @@ C_ASSERT( sizeof(struct fsync_msgwait_request) == 16 );
 C_ASSERT( sizeof(struct get_fsync_apc_idx_request) == 16 );
 C_ASSERT( FIELD_OFFSET(struct get_fsync_apc_idx_reply, shm_idx) == 8 );
 C_ASSERT( sizeof(struct get_fsync_apc_idx_reply) == 16 );
+C_ASSERT( sizeof(struct get_fsync_handle_map_request) == 16 );
 C_ASSERT( sizeof(struct update_rawinput_devices_request) == 16 );
 C_ASSERT( sizeof(struct get_rawinput_devices_request) == 16 );
 C_ASSERT( FIELD_OFFSET(struct get_rawinput_devices_reply, device_count) == 8 );
@@ -183,6 +183,7 @@ static void sighup_callback(void)
 #ifdef DEBUG_OBJECTS
     dump_objects();
 #endif
+    dump_request_stats();
 }
 
 /* SIGTERM callback */
@@ -348,7 +348,7 @@ static void cleanup_thread( struct thread *thread )
 
     clear_apc_queue( &thread->system_apc );
     clear_apc_queue( &thread->user_apc );
-    free( thread->req_data );
+    free_req_data( thread );
     free( thread->reply_data );
     if (thread->request_fd) release_object( thread->request_fd );
     if (thread->reply_fd) release_object( thread->reply_fd );
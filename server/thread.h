@@ -46,6 +46,9 @@ struct inflight_fd
 };
 #define MAX_INFLIGHT_FDS 16  /* max number of fds in flight per thread */
 
+/* size of the per-thread buffer holding small request data, so that most requests need no allocation */
+#define MAX_INLINE_REQ_DATA 512
+
 struct thread
 {
     struct object          obj;           /* object header */
@@ -68,6 +71,11 @@ struct thread
     unsigned int           error;         /* current error code */
     union generic_request  req;           /* current request */
     void                  *req_data;      /* variable-size data for request */
+    union
+    {
+        char               data[MAX_INLINE_REQ_DATA];
+        unsigned __int64   align;
+    }                      req_inline;    /* inline storage for small request data */
     unsigned int           req_toread;    /* amount of data still to read in request */
     void                  *reply_data;    /* variable-size data for reply */
     unsigned int           reply_size;    /* size of reply data */
@@ -1240,6 +1240,25 @@ static void dump_varargs_handle_infos( const char *prefix, data_size_t size )
     fputc( '}', stderr );
 }
 
+static void dump_varargs_completion_msgs( const char *prefix, data_size_t size )
+{
+    const struct completion_msg *msg;
+
+    fprintf( stderr, "%s{", prefix );
+    while (size >= sizeof(*msg))
+    {
+        msg = cur_data;
+        dump_uint64( "{ckey=", &msg->ckey );
+        dump_uint64( ",cvalue=", &msg->cvalue );
+        dump_uint64( ",information=", &msg->information );
+        fprintf( stderr, ",status=%08x}", msg->status );
+        size -= sizeof(*msg);
+        remove_data( sizeof(*msg) );
+        if (size) fputc( ',', stderr );
+    }
+    fputc( '}', stderr );
+}
+
 typedef void (*dump_func)( const void *req );
 
 /* Everything below this line is generated automatically by tools/make_requests */
@@ -1993,6 +2012,11 @@ static void dump_enable_socket_event_request( const struct enable_socket_event_r
     fprintf( stderr, ", cstate=%08x", req->cstate );
 }
 
+static void dump_enable_socket_event_reply( const struct enable_socket_event_reply *req )
+{
+    fprintf( stderr, " state=%08x", req->state );
+}
+
 static void dump_set_socket_deferred_request( const struct set_socket_deferred_request *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
@@ -4526,6 +4550,16 @@ static void dump_remove_completion_reply( const struct remove_completion_reply *
     fprintf( stderr, ", status=%08x", req->status );
 }
 
+static void dump_remove_completions_request( const struct remove_completions_request *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+}
+
+static void dump_remove_completions_reply( const struct remove_completions_reply *req )
+{
+    dump_varargs_completion_msgs( " msgs=", cur_size );
+}
+
 static void dump_query_completion_request( const struct query_completion_request *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
@@ -4692,6 +4726,10 @@ static void dump_get_fsync_apc_idx_reply( const struct get_fsync_apc_idx_reply *
     fprintf( stderr, " shm_idx=%08x", req->shm_idx );
 }
 
+static void dump_get_fsync_handle_map_request( const struct get_fsync_handle_map_request *req )
+{
+}
+
 static void dump_update_rawinput_devices_request( const struct update_rawinput_devices_request *req )
 {
     dump_varargs_rawinput_devices( " devices=", cur_size );
@@ -5135,6 +5173,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_open_completion_request,
     (dump_func)dump_add_completion_request,
     (dump_func)dump_remove_completion_request,
+    (dump_func)dump_remove_completions_request,
     (dump_func)dump_query_completion_request,
     (dump_func)dump_set_completion_info_request,
     (dump_func)dump_add_fd_completion_request,
@@ -5152,6 +5191,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_get_fsync_idx_request,
     (dump_func)dump_fsync_msgwait_request,
     (dump_func)dump_get_fsync_apc_idx_request,
+    (dump_func)dump_get_fsync_handle_map_request,
     (dump_func)dump_update_rawinput_devices_request,
     (dump_func)dump_get_rawinput_devices_request,
     (dump_func)dump_get_suspend_context_request,
@@ -5236,7 +5276,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     NULL,
     (dump_func)dump_get_socket_event_reply,
     (dump_func)dump_get_socket_info_reply,
-    NULL,
+    (dump_func)dump_enable_socket_event_reply,
     NULL,
     (dump_func)dump_alloc_console_reply,
     NULL,
@@ -5459,6 +5499,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_open_completion_reply,
     NULL,
     (dump_func)dump_remove_completion_reply,
+    (dump_func)dump_remove_completions_reply,
     (dump_func)dump_query_completion_reply,
     NULL,
     NULL,
@@ -5477,6 +5518,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     NULL,
     (dump_func)dump_get_fsync_apc_idx_reply,
     NULL,
+    NULL,
     (dump_func)dump_get_rawinput_devices_reply,
     (dump_func)dump_get_suspend_context_reply,
     NULL,
@@ -5783,6 +5825,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "open_completion",
     "add_completion",
     "remove_completion",
+    "remove_completions",
     "query_completion",
     "set_completion_info",
     "add_fd_completion",
@@ -5800,6 +5843,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "get_fsync_idx",
     "fsync_msgwait",
     "get_fsync_apc_idx",
+    "get_fsync_handle_map",
     "update_rawinput_devices",
     "get_rawinput_devices",
     "get_suspend_context",
@@ -6013,6 +6057,11 @@ static const char *get_status_name( unsigned int status )
     return buffer;
 }
 
+const char *get_request_name( enum request req )
+{
+    return req < REQ_NB_REQUESTS ? req_names[req] : "?";
+}
+
 void trace_request(void)
 {
     enum request req = current->req.request_header.req;
@@ -33,6 +33,7 @@
 #include "winternl.h"
 
 #include "object.h"
+#include "file.h"
 #include "request.h"
 #include "thread.h"
 #include "process.h"
@@ -188,6 +189,24 @@ static unsigned int get_monitor_dpi( struct window *win )
     return win->dpi ? win->dpi : USER_DEFAULT_SCREEN_DPI;
 }
 
+/* publish the window styles in the global shared memory; a zero handle clears the entry */
+static void update_shm_window( struct window *win, user_handle_t handle )
+{
+    shmwindow_t *shm;
+    unsigned int seq;
+
+    if (!shmglobal) return;
+
+    shm = &shmglobal->windows[((win->handle & 0xffff) - FIRST_USER_HANDLE) >> 1];
+    seq = shm->seq;
+    __atomic_store_n( &shm->seq, seq + 1, __ATOMIC_RELAXED );
+    __atomic_thread_fence( __ATOMIC_RELEASE );
+    shm->handle   = handle;
+    shm->style    = win->style;
+    shm->ex_style = win->ex_style;
+    __atomic_store_n( &shm->seq, seq + 2, __ATOMIC_RELEASE );
+}
+
 /* link a window at the right place in the siblings list */
 static void link_window( struct window *win, struct window *previous )
 {
@@ -241,6 +260,7 @@ static void link_window( struct window *win, struct window *previous )
     }
 
     win->is_linked = 1;
+    update_shm_window( win, win->handle );
 }
 
 /* change the parent of a window (or unlink the window if the new parent is NULL) */
@@ -548,6 +568,7 @@ static struct window *create_window( struct window *parent, struct window *owner
     }
 
     current->desktop_users++;
+    update_shm_window( win, win->handle );
     return win;
 
 failed:
@@ -968,13 +989,20 @@ static struct region *clip_children( struct window *parent, struct window *last,
 {
     struct window *ptr;
     struct region *tmp = create_empty_region();
+    rectangle_t rect, extents;
 
     if (!tmp) return NULL;
+
+    /* region extents in parent client coordinates, to quickly skip children that don't overlap */
+    get_region_extents( region, &extents );
+    offset_rect( &extents, -offset_x, -offset_y );
+
     LIST_FOR_EACH_ENTRY( ptr, &parent->children, struct window, entry )
     {
         if (ptr == last) break;
         if (!(ptr->style & WS_VISIBLE)) continue;
         if (ptr->ex_style & WS_EX_TRANSPARENT) continue;
+        if (!intersect_rect( &rect, &ptr->visible_rect, &extents )) continue;
         set_region_rect( tmp, &ptr->visible_rect );
         if (ptr->win_region && !intersect_window_region( tmp, ptr ))
         {
@@ -984,6 +1012,8 @@ static struct region *clip_children( struct window *parent, struct window *last,
         offset_region( tmp, offset_x, offset_y );
         if (!(region = subtract_region( region, region, tmp ))) break;
         if (is_region_empty( region )) break;
+        get_region_extents( region, &extents );
+        offset_rect( &extents, -offset_x, -offset_y );
     }
     free_region( tmp );
     return region;
@@ -1705,6 +1735,7 @@ static void set_window_pos( struct window *win, struct window *previous,
     if (!(swp_flags & SWP_NOZORDER) && win->parent) link_window( win, previous );
     if (swp_flags & SWP_SHOWWINDOW) win->style |= WS_VISIBLE;
     else if (swp_flags & SWP_HIDEWINDOW) win->style &= ~WS_VISIBLE;
+    update_shm_window( win, win->handle );
 
     /* keep children at the same position relative to top right corner when the parent is mirrored */
     if (win->ex_style & WS_EX_LAYOUTRTL)
@@ -1912,6 +1943,7 @@ void destroy_window( struct window *win )
     if (win == taskman_window) taskman_window = NULL;
     free_hotkeys( win->desktop, win->handle );
     cleanup_clipboard_window( win->desktop, win->handle );
+    update_shm_window( win, 0 );
     free_user_handle( win->handle );
     destroy_properties( win );
     list_remove( &win->entry );
@@ -2039,6 +2071,7 @@ DECL_HANDLER(get_desktop_window)
         {
             detach_window_thread( desktop->top_window );
             desktop->top_window->style  = WS_POPUP | WS_VISIBLE | WS_CLIPSIBLINGS | WS_CLIPCHILDREN;
+            update_shm_window( desktop->top_window, desktop->top_window->handle );
         }
     }
 
@@ -2051,6 +2084,7 @@ DECL_HANDLER(get_desktop_window)
         {
             detach_window_thread( desktop->msg_window );
             desktop->msg_window->style = WS_POPUP | WS_CLIPSIBLINGS | WS_CLIPCHILDREN;
+            update_shm_window( desktop->msg_window, desktop->msg_window->handle );
         }
     }
 
@@ -2151,6 +2185,7 @@ DECL_HANDLER(set_window_info)
         else win->ex_style = (req->ex_style & ~WS_EX_TOPMOST) | (win->ex_style & WS_EX_TOPMOST);
         if (!(win->ex_style & WS_EX_LAYERED)) win->is_layered = 0;
     }
+    if (req->flags & (SET_WIN_STYLE | SET_WIN_EXSTYLE)) update_shm_window( win, win->handle );
     if (req->flags & SET_WIN_ID) win->id = req->id;
     if (req->flags & SET_WIN_INSTANCE) win->instance = req->instance;
     if (req->flags & SET_WIN_UNICODE) win->is_unicode = req->is_unicode;